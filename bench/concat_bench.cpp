@@ -0,0 +1,38 @@
+// String-building benchmark: appends a short piece to a str variable until
+// it holds several megabytes ('s = s + ...', which the engines append in
+// place), on both engines, and reports the time per append.
+//   build/concat_bench [appends]
+#include "Program.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+	long long appends = argc > 1 ? std::atoll(argv[1]) : 1000000;
+	std::string source = "str s = \"\";\nint i = 0;\nwhile (i < " + std::to_string(appends) +
+		") {\n  s = s + \"item-\" + i % 10 + \";\";\n  i = i + 1;\n}\n";
+	std::printf("appends: %lld\n", appends);
+	for (Program::Engine engine : {Program::Engine::Tree, Program::Engine::VM}) {
+		Program::Options options;
+		options.engine = engine;
+		std::string errorMsg;
+		auto program = Program::compile(source, options, errorMsg);
+		if (!program) {
+			std::fprintf(stderr, "%s\n", errorMsg.c_str());
+			return 1;
+		}
+		Context context(*program);
+		auto start = std::chrono::steady_clock::now();
+		if (!context.run()) {
+			std::fprintf(stderr, "%s", context.errors().c_str());
+			return 1;
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::string text;
+		context.variable("s", text);
+		std::printf("%-4s  %10.1f ms  %6.1f ns/append  (%.1f MB)\n", engine == Program::Engine::VM ? "vm" : "tree",
+			ms, ms * 1e6 / static_cast<double>(appends), static_cast<double>(text.size()) / 1e6);
+	}
+	return 0;
+}
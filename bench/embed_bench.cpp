@@ -0,0 +1,58 @@
+// Embedding benchmark: a host compiles a triangle classifier once through
+// the library API and runs it for many inputs in-process, reporting the
+// latency of one Context::run().
+//   build/embed_bench [runs]
+#include "Program.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+static const char* kSource = R"(int a, b, c;
+read(a); read(b); read(c);
+if (a <= 0 || b <= 0 || c <= 0) {
+  print("invalido");
+} else if (a + b <= c || a + c <= b || b + c <= a) {
+  print("nao e triangulo");
+} else if (a == b && b == c) {
+  print("equilatero");
+} else if (a == b || b == c || a == c) {
+  print("isosceles");
+} else {
+  print("escaleno");
+}
+)";
+
+int main(int argc, char** argv) {
+	long long runs = argc > 1 ? std::atoll(argv[1]) : 1000000;
+	std::printf("runs: %lld\n", runs);
+	for (Program::Engine engine : {Program::Engine::Tree, Program::Engine::VM}) {
+		Program::Options options;
+		options.engine = engine;
+		std::string errorMsg;
+		auto program = Program::compile(kSource, options, errorMsg);
+		if (!program) {
+			std::fprintf(stderr, "%s\n", errorMsg.c_str());
+			return 1;
+		}
+		Context context(*program);
+		long long next = 0, field = 0, lines = 0;
+		context.setInput([&](std::string& line) {
+			line = std::to_string(1 + (next + field * 3) % 7);
+			field = (field + 1) % 3;
+			return true;
+		});
+		context.setOutput([&](std::string_view text) { if (text == "\n") lines++; });
+		auto start = std::chrono::steady_clock::now();
+		for (next = 0; next < runs; ++next) {
+			if (!context.run()) {
+				std::fprintf(stderr, "%s", context.errors().c_str());
+				return 1;
+			}
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::printf("%-4s  %10.1f ms  %6.3f us/run  (%lld lines)\n", engine == Program::Engine::VM ? "vm" : "tree",
+			ms, ms * 1e3 / static_cast<double>(runs), lines);
+	}
+	return 0;
+}
@@ -0,0 +1,172 @@
+// Lexer throughput benchmark: compares the scanner in src/Lexer.cpp with the
+// previous character-at-a-time implementation (kept below as "legacy") on a
+// generated multi-megabyte source and checks both produce the same tokens.
+//   build/lex_bench [megabytes] [repetitions]
+#include "Lexer.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace legacy {
+static bool isIdentStart(char c) {
+	return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+static bool isIdentChar(char c) {
+	return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+std::vector<Token> tokenize(std::string_view src, int firstLine = 1) {
+	bool inBlockComment = false;
+	std::vector<Token> tokens;
+	tokens.reserve(src.size() / 4 + 1);
+	int line = firstLine;
+	size_t i = 0;
+	while (i < src.size()) {
+		char c = src[i];
+		if (c == '\n') { line++; i++; continue; }
+		if (std::isspace(static_cast<unsigned char>(c))) { i++; continue; }
+
+		if (inBlockComment) {
+			// search for '*/'
+			if (c == '*' && i + 1 < src.size() && src[i+1] == '/') {
+				inBlockComment = false;
+				i += 2; continue;
+			}
+			i++; continue;
+		}
+
+		// line comment //
+		if (c == '/' && i + 1 < src.size() && src[i+1] == '/') {
+			while (i < src.size() && src[i] != '\n') i++; // ignore rest of line
+			continue;
+		}
+		// block comment start /*
+		if (c == '/' && i + 1 < src.size() && src[i+1] == '*') {
+			inBlockComment = true;
+			i += 2; continue;
+		}
+		// two-char operators
+		if (c == '&' && i + 1 < src.size() && src[i+1] == '&') { tokens.push_back({TokenType::AndAnd, "&&", line}); i += 2; continue; }
+		if (c == '|' && i + 1 < src.size() && src[i+1] == '|') { tokens.push_back({TokenType::OrOr, "||", line}); i += 2; continue; }
+		if (c == '=' && i + 1 < src.size() && src[i+1] == '=') { tokens.push_back({TokenType::EqualEqual, "==", line}); i += 2; continue; }
+		if (c == '!' && i + 1 < src.size() && src[i+1] == '=') { tokens.push_back({TokenType::BangEqual, "!=", line}); i += 2; continue; }
+		if (c == '<' && i + 1 < src.size() && src[i+1] == '=') { tokens.push_back({TokenType::LessEqual, "<=", line}); i += 2; continue; }
+		if (c == '>' && i + 1 < src.size() && src[i+1] == '=') { tokens.push_back({TokenType::GreaterEqual, ">=", line}); i += 2; continue; }
+
+		// single-char punctuation/operators
+		if (c == '(') { tokens.push_back({TokenType::LParen, "(", line}); i++; continue; }
+		if (c == ')') { tokens.push_back({TokenType::RParen, ")", line}); i++; continue; }
+		if (c == '{') { tokens.push_back({TokenType::LBrace, "{", line}); i++; continue; }
+		if (c == '}') { tokens.push_back({TokenType::RBrace, "}", line}); i++; continue; }
+		if (c == '!') { tokens.push_back({TokenType::Bang, "!", line}); i++; continue; }
+		if (c == '<') { tokens.push_back({TokenType::Less, "<", line}); i++; continue; }
+		if (c == '>') { tokens.push_back({TokenType::Greater, ">", line}); i++; continue; }
+		if (c == '=') { tokens.push_back({TokenType::Equals, "=", line}); i++; continue; }
+		if (c == ';') { tokens.push_back({TokenType::Semicolon, ";", line}); i++; continue; }
+		if (c == ',') { tokens.push_back({TokenType::Comma, ",", line}); i++; continue; }
+		if (c == '+') { tokens.push_back({TokenType::Plus, "+", line}); i++; continue; }
+
+		if (c == '"') {
+			// string literal (an unterminated literal ends at the end of its line)
+			size_t j = i + 1;
+			while (j < src.size() && src[j] != '"' && src[j] != '\n') j++;
+			tokens.push_back({TokenType::StrLiteral, src.substr(i+1, j-i-1), line});
+			i = (j < src.size() && src[j] == '"') ? j + 1 : j;
+			continue;
+		}
+
+		if (std::isdigit(static_cast<unsigned char>(c))) {
+			size_t j = i;
+			while (j < src.size() && std::isdigit(static_cast<unsigned char>(src[j]))) j++;
+			bool isFloat = false;
+			if (j < src.size() && src[j] == '.' && (j + 1) < src.size() && std::isdigit(static_cast<unsigned char>(src[j+1]))) {
+				isFloat = true;
+				j++;
+				while (j < src.size() && std::isdigit(static_cast<unsigned char>(src[j]))) j++;
+			}
+			tokens.push_back({isFloat ? TokenType::FloatLiteral : TokenType::IntLiteral, src.substr(i, j-i), line});
+			i = j; continue;
+		}
+
+		if (isIdentStart(c)) {
+			size_t j = i;
+			while (j < src.size() && isIdentChar(src[j])) j++;
+			std::string_view id = src.substr(i, j-i);
+			if (id == "print") tokens.push_back({TokenType::KeywordPrint, id, line});
+			else if (id == "read") tokens.push_back({TokenType::KeywordRead, id, line});
+			else if (id == "int") tokens.push_back({TokenType::KeywordInt, id, line});
+			else if (id == "str") tokens.push_back({TokenType::KeywordStr, id, line});
+			else if (id == "float") tokens.push_back({TokenType::KeywordFloat, id, line});
+			else if (id == "auto") tokens.push_back({TokenType::KeywordAuto, id, line});
+			else if (id == "if") tokens.push_back({TokenType::KeywordIf, id, line});
+			else if (id == "else") tokens.push_back({TokenType::KeywordElse, id, line});
+			else if (id == "timeexec") tokens.push_back({TokenType::KeywordTimeExec, id, line});
+			else tokens.push_back({TokenType::Identifier, id, line});
+			i = j; continue;
+		}
+
+		tokens.push_back({TokenType::Unknown, src.substr(i, 1), line});
+		i++;
+	}
+	tokens.push_back({TokenType::EndOfInput, "", line});
+	return tokens;
+}
+}
+
+static std::string generate(size_t targetBytes) {
+	std::string src;
+	src.reserve(targetBytes + 256);
+	for (int i = 0; src.size() < targetBytes; ++i) {
+		std::string n = std::to_string(i);
+		src += "// declaração número " + n + " com um comentário de linha razoavelmente longo\n";
+		src += "int contador_" + n + " = " + n + " + total_acumulado;\n";
+		src += "str nome_" + n + " = \"um texto literal qualquer com alguns caracteres " + n + "\";\n";
+		src += "/* bloco de comentário\n   com duas linhas */\n";
+		src += "if (contador_" + n + " >= 10 && !(total_acumulado == 3.25)) {\n\tprint(\"valor = {contador_" + n + "}\");\n} else {\n\ttotal_acumulado = total_acumulado + 1;\n}\n";
+	}
+	return src;
+}
+
+template <typename F>
+static double bestMs(int reps, F&& f) {
+	double best = 1e30;
+	for (int r = 0; r < reps; ++r) {
+		auto t0 = std::chrono::steady_clock::now();
+		f();
+		auto t1 = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+	}
+	return best;
+}
+
+int main(int argc, char** argv) {
+	size_t mb = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 16;
+	int reps = argc > 2 ? std::atoi(argv[2]) : 5;
+	std::string src = generate(mb * 1024 * 1024);
+
+	auto expected = legacy::tokenize(src);
+	auto actual = Lexer().tokenize(src);
+	if (expected.size() != actual.size()) {
+		std::fprintf(stderr, "token count mismatch: legacy %zu, current %zu\n", expected.size(), actual.size());
+		return 1;
+	}
+	for (size_t i = 0; i < expected.size(); ++i) {
+		if (expected[i].type != actual[i].type || expected[i].lexeme != actual[i].lexeme || expected[i].line != actual[i].line) {
+			std::fprintf(stderr, "token %zu differs (line %d)\n", i, expected[i].line);
+			return 1;
+		}
+	}
+
+	size_t sink = 0;
+	double legacyMs = bestMs(reps, [&] { sink += legacy::tokenize(src).size(); });
+	double currentMs = bestMs(reps, [&] { sink += Lexer().tokenize(src).size(); });
+	double megabytes = static_cast<double>(src.size()) / (1024.0 * 1024.0);
+	std::printf("source: %.1f MB, %zu tokens\n", megabytes, actual.size());
+	std::printf("legacy:  %8.2f ms  %8.1f MB/s\n", legacyMs, megabytes / (legacyMs / 1000.0));
+	std::printf("current: %8.2f ms  %8.1f MB/s  (%.2fx)\n", currentMs, megabytes / (currentMs / 1000.0), legacyMs / currentMs);
+	return sink == 0;
+}
@@ -0,0 +1,40 @@
+// Hot-loop benchmark: runs counting loops on both engines and reports time
+// per iteration.
+//   build/loop_bench [iterations]
+#include "Interpreter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+struct Workload {
+	const char* name;
+	std::string source;
+};
+
+static double runMs(Engine engine, const std::string& source) {
+	Interpreter interp;
+	interp.setEngine(engine);
+	if (!interp.compile(source)) std::exit(1);
+	auto start = std::chrono::steady_clock::now();
+	if (!interp.run()) std::exit(1);
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+	long long iterations = argc > 1 ? std::atoll(argv[1]) : 100000000;
+	std::string n = std::to_string(iterations);
+	Workload workloads[] = {
+		{"while i++", "int i = 0;\nwhile (i < " + n + ") {\n  i++;\n}\n"},
+		{"for sum  ", "int sum = 0;\nfor (int i = 0; i < " + n + "; i++) {\n  sum += i % 7;\n}\n"},
+	};
+	std::printf("iterations: %lld\n", iterations);
+	for (const auto& w : workloads) {
+		for (Engine engine : {Engine::Tree, Engine::VM}) {
+			double ms = runMs(engine, w.source);
+			std::printf("%s  %-4s  %10.1f ms  %6.2f ns/iter\n", w.name, engine == Engine::VM ? "vm" : "tree",
+				ms, ms * 1e6 / static_cast<double>(iterations));
+		}
+	}
+	return 0;
+}
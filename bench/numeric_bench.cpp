@@ -0,0 +1,80 @@
+// Numeric conversion microbenchmark: the Numeric module against the
+// std::to_string / std::stoll / std::stod calls it replaced, on the same
+// values, reporting ns per conversion.
+//   build/numeric_bench [count]
+#include "Numeric.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Keeps the optimizer from dropping the measured work.
+static size_t sink = 0;
+
+template <typename F>
+static double nsPer(size_t count, F work) {
+	auto start = std::chrono::steady_clock::now();
+	work();
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(count);
+}
+
+static void report(const char* what, double before, double after) {
+	std::printf("%-13s  std %7.1f ns  Numeric %7.1f ns  (%.1fx)\n", what, before, after, before / after);
+}
+
+int main(int argc, char** argv) {
+	size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+	std::vector<int64_t> ints(count);
+	std::vector<double> floats(count);
+	uint64_t x = 88172645463325252ull;
+	for (size_t i = 0; i < count; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift
+		ints[i] = static_cast<int64_t>(x % 2000000) - 1000000;
+		floats[i] = static_cast<double>(x % 1000000) / 997.0;
+	}
+	std::vector<std::string> intText, floatText;
+	for (size_t i = 0; i < count; ++i) {
+		intText.push_back(std::to_string(ints[i]));
+		floatText.push_back(std::to_string(floats[i]));
+	}
+	std::printf("count: %zu\n", count);
+
+	std::string out;
+	report("format int", nsPer(count, [&] {
+		for (int64_t v : ints) { out = std::to_string(v); sink += out.size(); }
+	}), nsPer(count, [&] {
+		for (int64_t v : ints) { out.clear(); Numeric::appendInt(out, v); sink += out.size(); }
+	}));
+	report("format float", nsPer(count, [&] {
+		for (double v : floats) { out = std::to_string(v); sink += out.size(); }
+	}), nsPer(count, [&] {
+		for (double v : floats) { out.clear(); Numeric::appendFloat(out, v); sink += out.size(); }
+	}));
+	report("parse int", nsPer(count, [&] {
+		for (const auto& t : intText) {
+			try { sink += static_cast<size_t>(std::stoll(t)); } catch (const std::exception&) {}
+		}
+	}), nsPer(count, [&] {
+		int64_t v;
+		for (const auto& t : intText) if (Numeric::parseInt(t, v)) sink += static_cast<size_t>(v);
+	}));
+	report("parse float", nsPer(count, [&] {
+		for (const auto& t : floatText) {
+			try { sink += static_cast<size_t>(std::stod(t)); } catch (const std::exception&) {}
+		}
+	}), nsPer(count, [&] {
+		double v;
+		for (const auto& t : floatText) if (Numeric::parseFloat(t, v)) sink += static_cast<size_t>(v);
+	}));
+	report("parse invalid", nsPer(count, [&] {
+		for (size_t i = 0; i < count; ++i) {
+			try { sink += static_cast<size_t>(std::stoll("abc")); } catch (const std::exception&) { sink++; }
+		}
+	}), nsPer(count, [&] {
+		int64_t v;
+		for (size_t i = 0; i < count; ++i) if (!Numeric::parseInt("abc", v)) sink++;
+	}));
+	return sink == 42 ? 1 : 0;
+}
@@ -0,0 +1,301 @@
+// Startup benchmark: lexes and parses a large generated script and reports
+// heap allocations and time per phase. The "heap" rows parse the same tokens
+// with the parser from before the arena (kept below as "legacy"): one
+// allocation per node, names and operators copied into std::string.
+//   build/parse_bench [statements] [repetitions]
+#include "Lexer.h"
+#include "Parser.h"
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+static size_t g_allocs = 0;
+
+void* operator new(size_t n) {
+	g_allocs++;
+	if (void* p = std::malloc(n ? n : 1)) return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace legacy {
+
+// The pre-arena AST, without evaluate()/execute(): only the layout and the
+// ownership matter here.
+struct Expr {
+	virtual ~Expr() = default;
+};
+struct LiteralExpr : Expr {
+	Value value;
+	explicit LiteralExpr(Value v) : value(std::move(v)) {}
+};
+struct IdentifierExpr : Expr {
+	std::string name;
+	int slot = -1;
+	explicit IdentifierExpr(std::string_view n) : name(n) {}
+};
+struct BinaryExpr : Expr {
+	std::string op;
+	std::unique_ptr<Expr> left, right;
+	BinaryExpr(std::string o, std::unique_ptr<Expr> l, std::unique_ptr<Expr> r) : op(std::move(o)), left(std::move(l)), right(std::move(r)) {}
+};
+struct UnaryExpr : Expr {
+	std::string op;
+	std::unique_ptr<Expr> expr;
+	UnaryExpr(std::string o, std::unique_ptr<Expr> e) : op(std::move(o)), expr(std::move(e)) {}
+};
+struct Stmt {
+	int line = 0;
+	virtual ~Stmt() = default;
+};
+struct VarDeclStmt : Stmt {
+	std::string typeName, varName;
+	int slot = -1;
+	std::unique_ptr<Expr> initExpr;
+	VarDeclStmt(std::string t, std::string_view n, std::unique_ptr<Expr> e) : typeName(std::move(t)), varName(n), initExpr(std::move(e)) {}
+};
+struct AssignStmt : Stmt {
+	std::string varName;
+	int slot = -1;
+	std::unique_ptr<Expr> expr;
+	AssignStmt(std::string_view n, std::unique_ptr<Expr> e) : varName(n), expr(std::move(e)) {}
+};
+struct PrintStmt : Stmt {
+	std::string content;
+	explicit PrintStmt(std::string_view c) : content(c) {}
+};
+struct BlockStmt : Stmt {
+	std::vector<std::unique_ptr<Stmt>> statements;
+};
+struct IfStmt : Stmt {
+	std::unique_ptr<Expr> condition;
+	std::unique_ptr<BlockStmt> thenBlock, elseBlock;
+	IfStmt(std::unique_ptr<Expr> c, std::unique_ptr<BlockStmt> t, std::unique_ptr<BlockStmt> e)
+		: condition(std::move(c)), thenBlock(std::move(t)), elseBlock(std::move(e)) {}
+};
+
+// Recursive descent as it was, limited to what generate() emits.
+class Parser {
+public:
+	std::unique_ptr<BlockStmt> parseProgram(const std::vector<Token>& t) {
+		auto program = std::make_unique<BlockStmt>();
+		size_t i = 0;
+		while (t[i].type != TokenType::EndOfInput) {
+			if (match(t, i, TokenType::Semicolon)) continue;
+			auto st = parseStatement(t, i);
+			if (!st) return nullptr;
+			program->statements.push_back(std::move(st));
+		}
+		return program;
+	}
+private:
+	static bool match(const std::vector<Token>& t, size_t& i, TokenType type) {
+		if (t[i].type == type) { i++; return true; }
+		return false;
+	}
+	template <class Next>
+	std::unique_ptr<Expr> binary(const std::vector<Token>& t, size_t& i, std::initializer_list<TokenType> ops, Next next) {
+		auto left = (this->*next)(t, i);
+		while (left) {
+			bool found = false;
+			for (TokenType op : ops) found = found || t[i].type == op;
+			if (!found) break;
+			std::string op(t[i].lexeme);
+			i++;
+			auto right = (this->*next)(t, i);
+			if (!right) return nullptr;
+			left = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
+		}
+		return left;
+	}
+	std::unique_ptr<Expr> parseTerm(const std::vector<Token>& t, size_t& i) {
+		const Token& tk = t[i];
+		if (tk.type == TokenType::LParen) {
+			i++;
+			auto e = parseExpression(t, i);
+			if (!e || !match(t, i, TokenType::RParen)) return nullptr;
+			return e;
+		}
+		if (tk.type == TokenType::IntLiteral) {
+			int64_t v = 0;
+			std::from_chars(tk.lexeme.data(), tk.lexeme.data() + tk.lexeme.size(), v);
+			i++;
+			return std::make_unique<LiteralExpr>(Value::fromInt(v));
+		}
+		if (tk.type == TokenType::FloatLiteral) {
+			double v = 0;
+			std::from_chars(tk.lexeme.data(), tk.lexeme.data() + tk.lexeme.size(), v);
+			i++;
+			return std::make_unique<LiteralExpr>(Value::fromFloat(v));
+		}
+		if (tk.type == TokenType::StrLiteral) { i++; return std::make_unique<LiteralExpr>(Value::fromStr(std::string(tk.lexeme))); }
+		if (tk.type == TokenType::Identifier) { i++; return std::make_unique<IdentifierExpr>(tk.lexeme); }
+		return nullptr;
+	}
+	std::unique_ptr<Expr> parseUnary(const std::vector<Token>& t, size_t& i) {
+		if (!match(t, i, TokenType::Bang)) return parseTerm(t, i);
+		auto e = parseUnary(t, i);
+		if (!e) return nullptr;
+		return std::make_unique<UnaryExpr>("!", std::move(e));
+	}
+	std::unique_ptr<Expr> parseAdditive(const std::vector<Token>& t, size_t& i) {
+		return binary(t, i, {TokenType::Plus}, &Parser::parseUnary);
+	}
+	std::unique_ptr<Expr> parseComparison(const std::vector<Token>& t, size_t& i) {
+		return binary(t, i, {TokenType::Less, TokenType::LessEqual, TokenType::Greater, TokenType::GreaterEqual}, &Parser::parseAdditive);
+	}
+	std::unique_ptr<Expr> parseEquality(const std::vector<Token>& t, size_t& i) {
+		return binary(t, i, {TokenType::EqualEqual, TokenType::BangEqual}, &Parser::parseComparison);
+	}
+	std::unique_ptr<Expr> parseLogicalAnd(const std::vector<Token>& t, size_t& i) {
+		return binary(t, i, {TokenType::AndAnd}, &Parser::parseEquality);
+	}
+	std::unique_ptr<Expr> parseExpression(const std::vector<Token>& t, size_t& i) {
+		return binary(t, i, {TokenType::OrOr}, &Parser::parseLogicalAnd);
+	}
+	std::unique_ptr<BlockStmt> parseBlock(const std::vector<Token>& t, size_t& i) {
+		if (!match(t, i, TokenType::LBrace)) return nullptr;
+		auto block = std::make_unique<BlockStmt>();
+		while (!match(t, i, TokenType::RBrace)) {
+			if (t[i].type == TokenType::EndOfInput) return nullptr;
+			if (match(t, i, TokenType::Semicolon)) continue;
+			auto st = parseStatement(t, i);
+			if (!st) return nullptr;
+			block->statements.push_back(std::move(st));
+		}
+		return block;
+	}
+	std::unique_ptr<Stmt> parseIf(const std::vector<Token>& t, size_t& i) {
+		int line = t[i].line;
+		i++;
+		if (!match(t, i, TokenType::LParen)) return nullptr;
+		auto cond = parseExpression(t, i);
+		if (!cond || !match(t, i, TokenType::RParen)) return nullptr;
+		auto thenBlock = parseBlock(t, i);
+		if (!thenBlock) return nullptr;
+		std::unique_ptr<BlockStmt> elseBlock;
+		if (match(t, i, TokenType::KeywordElse)) {
+			if (t[i].type == TokenType::KeywordIf) {
+				auto elseIf = parseIf(t, i);
+				if (!elseIf) return nullptr;
+				elseBlock = std::make_unique<BlockStmt>();
+				elseBlock->statements.push_back(std::move(elseIf));
+			} else if (!(elseBlock = parseBlock(t, i))) return nullptr;
+		}
+		auto st = std::make_unique<IfStmt>(std::move(cond), std::move(thenBlock), std::move(elseBlock));
+		st->line = line;
+		return st;
+	}
+	std::unique_ptr<Stmt> parseStatement(const std::vector<Token>& t, size_t& i) {
+		int line = t[i].line;
+		std::unique_ptr<Stmt> st;
+		TokenType type = t[i].type;
+		if (type == TokenType::KeywordIf) return parseIf(t, i);
+		if (type == TokenType::KeywordPrint) {
+			i++;
+			if (!match(t, i, TokenType::LParen) || t[i].type != TokenType::StrLiteral) return nullptr;
+			st = std::make_unique<PrintStmt>(t[i++].lexeme);
+			if (!match(t, i, TokenType::RParen)) return nullptr;
+		} else if (type == TokenType::KeywordInt || type == TokenType::KeywordStr || type == TokenType::KeywordFloat) {
+			std::string typeName(t[i++].lexeme);
+			if (t[i].type != TokenType::Identifier) return nullptr;
+			// Each declaration list became a block of VarDeclStmt.
+			auto block = std::make_unique<BlockStmt>();
+			std::string_view name = t[i++].lexeme;
+			std::unique_ptr<Expr> init;
+			if (match(t, i, TokenType::Equals) && !(init = parseExpression(t, i))) return nullptr;
+			block->statements.push_back(std::make_unique<VarDeclStmt>(typeName, name, std::move(init)));
+			block->statements.back()->line = line;
+			st = std::move(block);
+		} else if (type == TokenType::Identifier) {
+			std::string_view name = t[i++].lexeme;
+			if (!match(t, i, TokenType::Equals)) return nullptr;
+			auto e = parseExpression(t, i);
+			if (!e) return nullptr;
+			st = std::make_unique<AssignStmt>(name, std::move(e));
+		} else return nullptr;
+		match(t, i, TokenType::Semicolon);
+		st->line = line;
+		return st;
+	}
+};
+
+} // namespace legacy
+
+static std::string generate(int statements) {
+	std::string src = "int total = 0;\n";
+	for (int i = 0; i < statements; ++i) {
+		std::string v = "v" + std::to_string(i);
+		switch (i % 4) {
+			case 0: src += "int " + v + " = " + std::to_string(i) + " + total + 1;\n"; break;
+			case 1: src += "str " + v + " = \"item\" + " + std::to_string(i) + ";\n"; break;
+			case 2: src += "if (total < " + std::to_string(i) + " && !(total == 3)) {\n  total = total + 1;\n} else {\n  print(\"v = {total}\");\n}\n"; break;
+			case 3: src += "float " + v + " = 1.5 + " + std::to_string(i) + ";\n"; break;
+		}
+	}
+	return src;
+}
+
+int main(int argc, char** argv) {
+	int statements = argc > 1 ? std::atoi(argv[1]) : 200000;
+	int reps = argc > 2 ? std::atoi(argv[2]) : 5;
+	std::string src = generate(statements);
+
+	double lexBest = 1e30, parseBest = 1e30, freeBest = 1e30;
+	size_t lexAllocs = 0, parseAllocs = 0, tokenCount = 0;
+	for (int r = 0; r < reps; ++r) {
+		Lexer lexer;
+		Parser parser;
+		Arena arena;
+		parser.setArena(&arena);
+		std::string err;
+		auto t0 = std::chrono::steady_clock::now();
+		size_t a0 = g_allocs;
+		auto tokens = lexer.tokenize(src);
+		size_t a1 = g_allocs;
+		auto t1 = std::chrono::steady_clock::now();
+		auto program = parser.parseProgram(tokens, err);
+		auto t2 = std::chrono::steady_clock::now();
+		size_t a2 = g_allocs;
+		if (!program) { std::fprintf(stderr, "parse error: %s\n", err.c_str()); return 1; }
+		arena.release();
+		auto t3 = std::chrono::steady_clock::now();
+		freeBest = std::min(freeBest, std::chrono::duration<double, std::milli>(t3 - t2).count());
+		lexBest = std::min(lexBest, std::chrono::duration<double, std::milli>(t1 - t0).count());
+		parseBest = std::min(parseBest, std::chrono::duration<double, std::milli>(t2 - t1).count());
+		lexAllocs = a1 - a0;
+		parseAllocs = a2 - a1;
+		tokenCount = tokens.size();
+	}
+
+	double heapParseBest = 1e30, heapFreeBest = 1e30;
+	size_t heapParseAllocs = 0;
+	auto tokens = Lexer().tokenize(src);
+	for (int r = 0; r < reps; ++r) {
+		auto t0 = std::chrono::steady_clock::now();
+		size_t a0 = g_allocs;
+		auto program = legacy::Parser().parseProgram(tokens);
+		size_t a1 = g_allocs;
+		auto t1 = std::chrono::steady_clock::now();
+		if (!program) { std::fprintf(stderr, "legacy parser failed\n"); return 1; }
+		program.reset();
+		auto t2 = std::chrono::steady_clock::now();
+		heapParseBest = std::min(heapParseBest, std::chrono::duration<double, std::milli>(t1 - t0).count());
+		heapFreeBest = std::min(heapFreeBest, std::chrono::duration<double, std::milli>(t2 - t1).count());
+		heapParseAllocs = a1 - a0;
+	}
+
+	std::printf("source: %zu bytes, %d statements, %zu tokens\n", src.size(), statements, tokenCount);
+	std::printf("lex:          %9.3f ms  %9zu allocations\n", lexBest, lexAllocs);
+	std::printf("parse:        %9.3f ms  %9zu allocations\n", parseBest, parseAllocs);
+	std::printf("parse (heap): %9.3f ms  %9zu allocations\n", heapParseBest, heapParseAllocs);
+	std::printf("free:         %9.3f ms\n", freeBest);
+	std::printf("free (heap):  %9.3f ms\n", heapFreeBest);
+	return 0;
+}
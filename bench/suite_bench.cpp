@@ -0,0 +1,260 @@
+// Regression suite: generates scripts that stress one part of the
+// interpreter each, times lex, parse and execute (on both engines) over
+// several repetitions and compares the means with a stored baseline.
+//   build/suite_bench [--scale N] [--reps N] [--baseline file] [--save file]
+#include "Interpreter.h"
+#include "Output.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+struct Workload {
+	const char* name;
+	std::string source;
+};
+
+// Many top-level declarations of every type: lexer, parser and resolver.
+static std::string genDecls(int scale) {
+	std::string src;
+	for (int i = 0; i < 100000 * scale; ++i) {
+		std::string v = "d" + std::to_string(i);
+		switch (i % 4) {
+			case 0: src += "int " + v + " = " + std::to_string(i) + " * 3 + 1;\n"; break;
+			case 1: src += "float " + v + " = " + std::to_string(i) + ".25;\n"; break;
+			case 2: src += "str " + v + " = \"value " + std::to_string(i) + "\";\n"; break;
+			case 3: src += "auto " + v + " = d" + std::to_string(i - 3) + " + 2;\n"; break;
+		}
+	}
+	return src;
+}
+
+// Deeply parenthesized expressions over a variable, so the optimizer cannot
+// fold them away.
+static std::string genNesting(int scale) {
+	const int depth = 64;
+	std::string expr = "x";
+	for (int d = 0; d < depth; ++d) expr = "(" + expr + (d % 2 ? " - 1)" : " + 2)");
+	std::string src = "int x = 0;\nint n = 0;\nwhile (n < " + std::to_string(1000 * scale) + ") {\n";
+	for (int i = 0; i < 50; ++i) src += "  x = " + expr + " % 1000;\n";
+	src += "  n++;\n}\nprint(\"x = {x}\");\n";
+	return src;
+}
+
+// A long if / else if chain walked for many values.
+static std::string genIfChain(int scale) {
+	const int branches = 300;
+	std::string src = "int hits = 0;\nint m = 0;\nfor (int k = 0; k < " + std::to_string(20000 * scale) + "; k++) {\n  m = k % " +
+		std::to_string(branches) + ";\n  ";
+	for (int b = 0; b < branches; ++b) {
+		if (b) src += " else ";
+		src += "if (m == " + std::to_string(b) + ") {\n    hits += " + std::to_string(b % 7) + ";\n  }";
+	}
+	src += "\n}\nprint(\"hits = {hits}\");\n";
+	return src;
+}
+
+// print() interpolation and string concatenation in a loop.
+static std::string genPrint(int scale) {
+	return "str name = \"item\";\nfloat price = 1.5;\nstr label = \"\";\n"
+		"for (int i = 0; i < " + std::to_string(200000 * scale) + "; i++) {\n"
+		"  label = name + \"-\" + i;\n"
+		"  price += 0.25;\n"
+		"  print(\"{i}: {label} costs {price} ({name}/{i})\");\n"
+		"}\n";
+}
+
+struct Stats {
+	std::vector<double> samples;
+	// Interference from other processes only ever adds time, so the slowest
+	// fifth of the samples is dropped before the mean and stddev; a real
+	// regression moves every sample and still shows.
+	std::vector<double> kept() const {
+		std::vector<double> sorted = samples;
+		std::sort(sorted.begin(), sorted.end());
+		size_t keep = sorted.size() - sorted.size() / 5;
+		sorted.resize(keep);
+		return sorted;
+	}
+	double mean() const {
+		std::vector<double> xs = kept();
+		double s = 0;
+		for (double x : xs) s += x;
+		return xs.empty() ? 0 : s / static_cast<double>(xs.size());
+	}
+	double stddev() const {
+		std::vector<double> xs = kept();
+		if (xs.size() < 2) return 0;
+		double m = mean(), s = 0;
+		for (double x : xs) s += (x - m) * (x - m);
+		return std::sqrt(s / static_cast<double>(xs.size() - 1));
+	}
+};
+
+// Discards program output so print-heavy workloads measure the interpreter,
+// not the terminal.
+struct NullBuf : std::streambuf {
+	int overflow(int c) override { return c; }
+	std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+static double ms(Trace::Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+// One compile + run; adds the phase times to the stats under "<name>/<phase>".
+static bool measure(const Workload& w, Engine engine, std::map<std::string, Stats>& stats) {
+	NullBuf sink;
+	std::streambuf* saved = std::cout.rdbuf(&sink);
+	Interpreter interp;
+	interp.setEngine(engine);
+	bool ok = interp.execute(w.source);
+	Out::flush();
+	std::cout.rdbuf(saved);
+	if (!ok) return false;
+	const Trace& trace = interp.phaseTrace();
+	std::string key = w.name;
+	if (engine == Engine::Tree) {
+		stats[key + "/lex"].samples.push_back(ms(trace.total(Phase::Lex)));
+		stats[key + "/parse"].samples.push_back(ms(trace.total(Phase::Parse)));
+	}
+	stats[key + (engine == Engine::VM ? "/execute-vm" : "/execute-tree")].samples.push_back(ms(trace.total(Phase::Execute)));
+	return true;
+}
+
+struct Reference {
+	double mean = 0;
+	double stddev = 0;
+};
+
+// Baseline lines: "<workload>/<phase> <mean ms> [<stddev ms>]"; '#' starts a
+// comment.
+static std::map<std::string, Reference> loadBaseline(const std::string& path) {
+	std::map<std::string, Reference> base;
+	std::ifstream in(path);
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.empty() || line[0] == '#') continue;
+		std::istringstream fields(line);
+		std::string key;
+		Reference ref;
+		if (!(fields >> key >> ref.mean)) continue;
+		if (!(fields >> ref.stddev)) ref.stddev = 0;
+		base[key] = ref;
+	}
+	return base;
+}
+
+// Differences below this are timer resolution and scheduling, whatever the
+// percentage (lex and parse of the small workloads take a few µs).
+constexpr double kMinDeltaMs = 0.05;
+
+// --save refuses a run whose relative stddev exceeds this on any row (above
+// timer resolution): a baseline recorded on a busy machine widens the noise
+// allowance until real regressions pass unnoticed.
+constexpr double kMaxSaveNoise = 0.10;
+
+int main(int argc, char** argv) {
+	int scale = 1, reps = 10;
+	std::string baselinePath, savePath;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--scale" && hasValue) scale = std::atoi(argv[++i]);
+		else if (arg == "--reps" && hasValue) reps = std::atoi(argv[++i]);
+		else if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+		else if (arg == "--save" && hasValue) savePath = argv[++i];
+		else {
+			std::fprintf(stderr, "usage: %s [--scale N] [--reps N] [--baseline file] [--save file]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (scale < 1) scale = 1;
+	if (reps < 1) reps = 1;
+
+	Workload workloads[] = {
+		{"decls", genDecls(scale)},
+		{"nesting", genNesting(scale)},
+		{"ifchain", genIfChain(scale)},
+		{"print", genPrint(scale)},
+	};
+	std::map<std::string, Stats> stats;
+	std::vector<std::string> order;
+	for (const auto& w : workloads) {
+		for (const char* phase : {"/lex", "/parse", "/execute-tree", "/execute-vm"}) order.push_back(w.name + std::string(phase));
+		// warm-up run, not recorded
+		std::map<std::string, Stats> discard;
+		if (!measure(w, Engine::Tree, discard)) {
+			std::fprintf(stderr, "workload %s failed\n", w.name);
+			return 1;
+		}
+		for (int r = 0; r < reps; ++r) {
+			if (!measure(w, Engine::Tree, stats) || !measure(w, Engine::VM, stats)) {
+				std::fprintf(stderr, "workload %s failed\n", w.name);
+				return 1;
+			}
+		}
+	}
+
+	std::map<std::string, Reference> base;
+	if (!baselinePath.empty()) base = loadBaseline(baselinePath);
+	std::printf("scale %d, %d repetitions\n", scale, reps);
+	std::printf("%-22s %10s %9s %10s %10s %8s\n", "workload/phase", "mean ms", "stddev", "min ms", "baseline", "change");
+	int regressions = 0;
+	for (const auto& key : order) {
+		const Stats& s = stats[key];
+		double mean = s.mean(), sd = s.stddev(), best = mean;
+		for (double x : s.samples) best = std::min(best, x);
+		std::printf("%-22s %10.3f %9.3f %10.3f", key.c_str(), mean, sd, best);
+		auto it = base.find(key);
+		if (it == base.end() || it->second.mean <= 0) {
+			std::printf(" %10s %8s\n", "-", "-");
+			continue;
+		}
+		const Reference& ref = it->second;
+		double delta = mean - ref.mean;
+		double change = delta / ref.mean * 100.0;
+		// Slower by more than 10%, by more than the noise of both runs and
+		// by more than the timer can tell apart.
+		double noise = 2 * std::sqrt(sd * sd + ref.stddev * ref.stddev);
+		bool regressed = change > 10.0 && delta > noise && delta > kMinDeltaMs;
+		if (regressed) regressions++;
+		std::printf(" %10.3f %+7.1f%%%s\n", ref.mean, change, regressed ? "  REGRESSION" : "");
+	}
+	if (!baselinePath.empty() && base.empty()) std::printf("no baseline in %s\n", baselinePath.c_str());
+	else if (!baselinePath.empty()) std::printf("%d regression(s) against %s\n", regressions, baselinePath.c_str());
+
+	if (!savePath.empty()) {
+		int noisy = 0;
+		for (const auto& key : order) {
+			const Stats& s = stats[key];
+			double mean = s.mean(), sd = s.stddev();
+			if (sd > kMaxSaveNoise * mean && sd > kMinDeltaMs) {
+				std::fprintf(stderr, "%s: stddev %.3f ms is %.1f%% of the mean\n", key.c_str(), sd, sd / mean * 100.0);
+				noisy++;
+			}
+		}
+		if (noisy) {
+			std::fprintf(stderr, "not saving %s: %d row(s) noisier than %.0f%%; re-run on an idle machine\n", savePath.c_str(),
+				noisy, kMaxSaveNoise * 100.0);
+			return 1;
+		}
+		std::ofstream out(savePath);
+		if (!out) {
+			std::fprintf(stderr, "cannot write %s\n", savePath.c_str());
+			return 1;
+		}
+		out << "# suite_bench baseline, scale " << scale << ", " << reps << " repetitions; <workload>/<phase> <mean ms> <stddev ms>\n";
+		for (const auto& key : order) {
+			char value[64];
+			std::snprintf(value, sizeof value, "%.3f %.3f", stats[key].mean(), stats[key].stddev());
+			out << key << ' ' << value << '\n';
+		}
+	}
+	return 0;
+}
@@ -1,113 +1,197 @@
 #ifndef AST_H
 #define AST_H
 
-#include <memory>
+#include <chrono>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
-
-using VarTable = std::unordered_map<std::string, std::string>;
-using TypeTable = std::unordered_map<std::string, std::string>;
-
-struct Expr {
-	virtual ~Expr() = default;
-	virtual std::string evaluate(VarTable& vars, TypeTable& types) = 0;
+#include "Arena.h"
+#include "Value.h"
+
+class Profiler;
+class Trace;
+
+// Declared type of a variable slot; Undeclared until its declaration runs.
+enum class VarType : uint8_t { Undeclared, Int, Float, Str };
+
+// Name <-> slot mapping built by the Resolver. Only compile-time passes and
+// diagnostics look names up; the runtime indexes slots directly.
+struct SymbolTable {
+	std::vector<std::string> names;
+	// Lags behind names when they are loaded from a program cache; the
+	// missing entries are added on the next intern() or lookup().
+	std::unordered_map<std::string, int> slots;
+	std::vector<bool> declared; // a declaration of the slot has been resolved
+	int intern(std::string_view name);
+	int lookup(std::string_view name);
+	size_t size() const { return names.size(); }
+	// Drops the slots added after the table had `n` names and puts the
+	// declared flags back, undoing a compilation that failed.
+	void truncate(size_t n, std::vector<bool> declaredBefore);
+private:
+	void indexPending();
 };
 
-struct IntLiteralExpr : Expr {
-	std::string value;
-	explicit IntLiteralExpr(const std::string& v) : value(v) {}
-	std::string evaluate(VarTable& /*vars*/, TypeTable& /*types*/) override { return value; }
+// Variable storage for one execution: one contiguous entry per slot.
+struct Frame {
+	std::vector<Value> values;
+	std::vector<VarType> types;
+	const SymbolTable* symbols = nullptr;
+	bool fault = false; // an expression failed; the running statement stops
+	bool timeExec = false; // timeexec() has run
+	Profiler* profiler = nullptr; // set while running under --profile
+	Trace* trace = nullptr; // receives time blocked in read()
+	void resize(size_t n) { values.resize(n); types.resize(n, VarType::Undeclared); }
+	// Every slot back to undeclared, for another run of the same program.
+	void reset() {
+		values.assign(values.size(), Value());
+		types.assign(types.size(), VarType::Undeclared);
+		fault = false;
+		timeExec = false;
+	}
 };
 
-struct StrLiteralExpr : Expr {
-	std::string value;
-	explicit StrLiteralExpr(const std::string& v) : value(v) {}
-	std::string evaluate(VarTable& /*vars*/, TypeTable& /*types*/) override { return value; }
+enum class ExprKind { Literal, Identifier, Binary, Unary };
+enum class StmtKind { VarDecl, Assign, Print, Read, Block, If, While, TimeExec };
+
+// Nodes are allocated in the program's Arena (see Parser) and are never
+// deleted one by one, hence the protected non-virtual destructors.
+struct Expr {
+	const ExprKind kind;
+	explicit Expr(ExprKind k) : kind(k) {}
+	virtual Value evaluate(Frame& frame) = 0;
+protected:
+	~Expr() = default;
 };
 
-struct FloatLiteralExpr : Expr {
-	std::string value;
-	explicit FloatLiteralExpr(const std::string& v) : value(v) {}
-	std::string evaluate(VarTable& /*vars*/, TypeTable& /*types*/) override { return value; }
+// int, float and str literals; the value is built once by the parser.
+struct LiteralExpr : Expr {
+	Value value;
+	explicit LiteralExpr(Value v) : Expr(ExprKind::Literal), value(std::move(v)) {}
+	Value evaluate(Frame& /*frame*/) override { return value; }
 };
 
 struct IdentifierExpr : Expr {
-	std::string name;
-	explicit IdentifierExpr(const std::string& n) : name(n) {}
-	std::string evaluate(VarTable& vars, TypeTable& /*types*/) override;
+	std::string_view name;
+	int slot = -1; // assigned by the Resolver
+	explicit IdentifierExpr(std::string_view n) : Expr(ExprKind::Identifier), name(n) {}
+	Value evaluate(Frame& frame) override;
 };
 
+// Abstract: nodes are created by makeBinary()/makeUnary(), which pick a
+// class per operator, or by the TypeChecker's typed nodes (TypedExpr.h).
 struct BinaryExpr : Expr {
-	std::string op; // '+', '==', '!=', '<', '<=', '>', '>=', '&&', '||'
-	std::unique_ptr<Expr> left;
-	std::unique_ptr<Expr> right;
-	BinaryExpr(std::string o, std::unique_ptr<Expr> l, std::unique_ptr<Expr> r)
-		: op(std::move(o)), left(std::move(l)), right(std::move(r)) {}
-	std::string evaluate(VarTable& vars, TypeTable& types) override;
+	BinaryOp op;
+	Expr* left;
+	Expr* right;
+	BinaryExpr(BinaryOp o, Expr* l, Expr* r)
+		: Expr(ExprKind::Binary), op(o), left(l), right(r) {}
 };
 
 struct UnaryExpr : Expr {
-	std::string op; // '!'
-	std::unique_ptr<Expr> expr;
-	UnaryExpr(std::string o, std::unique_ptr<Expr> e) : op(std::move(o)), expr(std::move(e)) {}
-	std::string evaluate(VarTable& vars, TypeTable& types) override;
+	UnaryOp op;
+	Expr* expr;
+	UnaryExpr(UnaryOp o, Expr* e) : Expr(ExprKind::Unary), op(o), expr(e) {}
 };
 
+// && and || short-circuit: the right operand runs only when the left one
+// does not decide the result.
+BinaryExpr* makeBinary(Arena& arena, BinaryOp op, Expr* left, Expr* right);
+UnaryExpr* makeUnary(Arena& arena, UnaryOp op, Expr* operand);
+
+// Operands a, b, ... of e = 'x + a + b ...' where x is the variable in slot
+// and no operand reads x, in order; 0 when e has another shape or more than
+// kMaxAppendTails operands.
+constexpr int kMaxAppendTails = 8;
+int appendTails(Expr* e, int slot, Expr* (&tails)[kMaxAppendTails]);
+
 struct Stmt {
-	virtual ~Stmt() = default;
-	virtual bool execute(VarTable& vars, TypeTable& types) = 0; // returns false on fatal error
+	const StmtKind kind;
+	int line = 0; // source line, reported by Err while the statement runs
+	int site = -1; // profiler site, assigned only under --profile
+	explicit Stmt(StmtKind k) : kind(k) {}
+	virtual bool execute(Frame& frame) = 0; // returns false on fatal error
+protected:
+	~Stmt() = default;
 };
 
 struct VarDeclStmt : Stmt {
-	std::string typeName; // "int", "str", "float", "auto"
-	std::string varName;
-	std::unique_ptr<Expr> initExpr; 
+	std::string_view typeName; // "int", "str", "float", "auto"
+	std::string_view varName;
+	int slot = -1;
+	VarType declType = VarType::Undeclared; // resolved from typeName; Undeclared means auto
+	Expr* initExpr;
 
-	VarDeclStmt(const std::string& t, const std::string& n, std::unique_ptr<Expr> e)
-		: typeName(t), varName(n), initExpr(std::move(e)) {}
+	VarDeclStmt(std::string_view t, std::string_view n, Expr* e)
+		: Stmt(StmtKind::VarDecl), typeName(t), varName(n), initExpr(e) {}
 
-	bool execute(VarTable& vars, TypeTable& types) override;
+	bool execute(Frame& frame) override;
 };
 
 struct AssignStmt : Stmt {
-	std::string varName;
-	std::unique_ptr<Expr> expr;
-	AssignStmt(const std::string& n, std::unique_ptr<Expr> e)
-		: varName(n), expr(std::move(e)) {}
-	bool execute(VarTable& vars, TypeTable& types) override;
+	std::string_view varName;
+	int slot = -1;
+	Expr* expr;
+	// expr is 'varName + a + ...' and the variable may be a str: both engines
+	// then append a, ... to its text in place (set by the TypeChecker).
+	bool appendsInPlace = false;
+	AssignStmt(std::string_view n, Expr* e)
+		: Stmt(StmtKind::Assign), varName(n), expr(e) {}
+	bool execute(Frame& frame) override;
+};
+
+// One piece of a print() template: literal text, or a {name} placeholder
+// (text then holds the name).
+struct PrintPart {
+	std::string_view text;
+	bool variable = false;
+	int slot = -1; // assigned by the Resolver for placeholders
 };
 
+// The template is split into parts by the parser, so execution only appends.
 struct PrintStmt : Stmt {
-	std::string content; 
-	explicit PrintStmt(const std::string& c) : content(c) {}
-	bool execute(VarTable& vars, TypeTable& types) override;
+	ArenaArray<PrintPart> parts;
+	explicit PrintStmt(ArenaArray<PrintPart> p) : Stmt(StmtKind::Print), parts(p) {}
+	bool execute(Frame& frame) override;
 };
 
 struct ReadStmt : Stmt {
-	std::string varName;
-	explicit ReadStmt(const std::string& n) : varName(n) {}
-	bool execute(VarTable& vars, TypeTable& types) override;
+	std::string_view varName;
+	int slot = -1;
+	explicit ReadStmt(std::string_view n) : Stmt(StmtKind::Read), varName(n) {}
+	bool execute(Frame& frame) override;
 };
 
 struct BlockStmt : Stmt {
-	std::vector<std::unique_ptr<Stmt>> statements;
-	bool execute(VarTable& vars, TypeTable& types) override;
+	ArenaArray<Stmt*> statements;
+	BlockStmt() : Stmt(StmtKind::Block) {}
+	bool execute(Frame& frame) override;
 };
 
 struct IfStmt : Stmt {
-	std::unique_ptr<Expr> condition;
-	std::unique_ptr<BlockStmt> thenBlock;
-	std::unique_ptr<BlockStmt> elseBlock; 
-	IfStmt(std::unique_ptr<Expr> cond, std::unique_ptr<BlockStmt> thenB, std::unique_ptr<BlockStmt> elseB)
-		: condition(std::move(cond)), thenBlock(std::move(thenB)), elseBlock(std::move(elseB)) {}
-	bool execute(VarTable& vars, TypeTable& types) override;
+	Expr* condition;
+	BlockStmt* thenBlock;
+	BlockStmt* elseBlock; // null when there is no else
+	IfStmt(Expr* cond, BlockStmt* thenB, BlockStmt* elseB)
+		: Stmt(StmtKind::If), condition(cond), thenBlock(thenB), elseBlock(elseB) {}
+	bool execute(Frame& frame) override;
+};
+
+// while (cond) { body }. A for loop is its init statement followed by a
+// WhileStmt whose step runs after every iteration of the body.
+struct WhileStmt : Stmt {
+	Expr* condition;
+	BlockStmt* body;
+	Stmt* step; // null for while
+	WhileStmt(Expr* cond, BlockStmt* b, Stmt* s)
+		: Stmt(StmtKind::While), condition(cond), body(b), step(s) {}
+	bool execute(Frame& frame) override;
 };
 
 struct TimeExecStmt : Stmt {
-	bool& flagRef;
-	explicit TimeExecStmt(bool& f) : flagRef(f) {}
-	bool execute(VarTable& /*vars*/, TypeTable& /*types*/) override { flagRef = true; return true; }
+	TimeExecStmt() : Stmt(StmtKind::TimeExec) {}
+	bool execute(Frame& frame) override { frame.timeExec = true; return true; }
 };
 
 #endif
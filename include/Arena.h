@@ -0,0 +1,135 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed-size array whose storage lives in an Arena.
+template <typename T>
+struct ArenaArray {
+	T* data = nullptr;
+	size_t count = 0;
+	T* begin() const { return data; }
+	T* end() const { return data + count; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	T& operator[](size_t i) const { return data[i]; }
+	T& back() const { return data[count - 1]; }
+};
+
+// Bump allocator owning every node and interned string of one compiled
+// program. Memory is handed out from large blocks and given back in a single
+// release(); only objects with non-trivial destructors are tracked.
+class Arena {
+public:
+	Arena() = default;
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+	~Arena() { release(); }
+
+	void* allocate(size_t size, size_t align) {
+		size_t offset = (used + align - 1) & ~(align - 1);
+		if (blocks.empty() || offset + size > capacity) {
+			newBlock(size + align);
+			offset = (used + align - 1) & ~(align - 1);
+		}
+		used = offset + size;
+		bytes += size;
+		return blocks.back().get() + offset;
+	}
+
+	template <typename T, typename... Args>
+	T* make(Args&&... args) {
+		T* obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		if (!std::is_trivially_destructible<T>::value)
+			dtors.push_back({obj, [](void* p) { static_cast<T*>(p)->~T(); }});
+		return obj;
+	}
+
+	// Copies items[from..] into the arena.
+	template <typename T>
+	ArenaArray<T> copyArray(const std::vector<T>& items, size_t from = 0) {
+		static_assert(std::is_trivially_copyable<T>::value, "ArenaArray holds trivially copyable items");
+		ArenaArray<T> out;
+		out.count = items.size() - from;
+		if (out.count == 0) return out;
+		out.data = static_cast<T*>(allocate(sizeof(T) * out.count, alignof(T)));
+		std::memcpy(out.data, items.data() + from, sizeof(T) * out.count);
+		return out;
+	}
+
+	// Copies a string into the arena once; equal strings share storage.
+	std::string_view intern(std::string_view s) {
+		if ((internCount + 1) * 2 > internSlots.size()) growInternTable();
+		size_t mask = internSlots.size() - 1;
+		size_t i = hashOf(s) & mask;
+		while (internSlots[i].data()) {
+			if (internSlots[i] == s) return internSlots[i];
+			i = (i + 1) & mask;
+		}
+		char* p = static_cast<char*>(allocate(s.size() + 1, 1));
+		std::memcpy(p, s.data(), s.size());
+		p[s.size()] = '\0';
+		internSlots[i] = std::string_view(p, s.size());
+		internCount++;
+		return internSlots[i];
+	}
+
+	size_t bytesAllocated() const { return bytes; }
+
+	void release() {
+		for (auto it = dtors.rbegin(); it != dtors.rend(); ++it) it->destroy(it->obj);
+		dtors.clear();
+		blocks.clear();
+		internSlots.clear();
+		used = capacity = bytes = internCount = 0;
+	}
+
+private:
+	struct Dtor { void* obj; void (*destroy)(void*); };
+	static constexpr size_t kBlockSize = 64 * 1024;
+
+	static size_t hashOf(std::string_view s) {
+		uint64_t h = 1469598103934665603ull; // FNV-1a
+		for (unsigned char c : s) { h ^= c; h *= 1099511628211ull; }
+		return static_cast<size_t>(h);
+	}
+
+	void growInternTable() {
+		std::vector<std::string_view> old = std::move(internSlots);
+		internSlots.assign(old.empty() ? 256 : old.size() * 2, std::string_view());
+		size_t mask = internSlots.size() - 1;
+		for (auto& v : old) {
+			if (!v.data()) continue;
+			size_t i = hashOf(v) & mask;
+			while (internSlots[i].data()) i = (i + 1) & mask;
+			internSlots[i] = v;
+		}
+	}
+
+	void newBlock(size_t minSize) {
+		capacity = minSize > kBlockSize ? minSize : kBlockSize;
+		blocks.emplace_back(new char[capacity]);
+		used = 0;
+	}
+
+	std::vector<std::unique_ptr<char[]>> blocks;
+	std::vector<Dtor> dtors;
+	std::vector<std::string_view> internSlots; // open-addressing intern table
+	size_t internCount = 0;
+	size_t used = 0;
+	size_t capacity = 0;
+	size_t bytes = 0;
+};
+
+#endif
+
+
@@ -0,0 +1,20 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string_view>
+
+class Interpreter;
+
+// --batch: runs one compiled program once per input record on a pool of
+// worker threads. Each line of input is a record; read() takes its
+// whitespace-separated fields in order (bulk mode: no prompts). Every
+// worker has its own frame, VM stack and output buffers; the program is
+// shared read-only. Workers start with equal slices of the records and
+// idle ones steal half of the largest slice left. Each record's output
+// goes to stdout and its diagnostics to stderr, in input order.
+namespace Batch {
+	// Returns whether any record ran timeexec().
+	bool run(const Interpreter& interp, std::string_view input, unsigned jobs);
+}
+
+#endif
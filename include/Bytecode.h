@@ -0,0 +1,55 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AST.h"
+#include "Value.h"
+
+// Stack machine instruction set. Operands live in Instr::arg (a constant,
+// slot, string or jump target index) and Instr::aux (small immediates).
+enum class OpCode : uint8_t {
+	Const,       // push constants[arg]
+	Load,        // push variable slot arg
+	Add,         // a b -> a+b
+	Sub, Mul, Div, Mod, // a b -> a op b (fatal on non-numbers, int division by 0)
+	Neg,         // a -> -a
+	Eq, Ne, Lt, Le, Gt, Ge, // a b -> bool
+	Not,         // a -> !a
+	ToBool,      // a -> bool (right operand of && and ||)
+	Jump,        // pc = arg (backwards for loops)
+	JumpIfFalse, // pop cond; if falsy pc = arg
+	AndJump,     // &&: if a is falsy, a -> false and pc = arg; else pop a
+	OrJump,      // ||: if a is truthy, a -> true and pc = arg; else pop a
+	Decl,        // pop value, declare slot arg with VarType aux
+	Store,       // pop value, assign slot arg
+	Append,      // pop aux values, append them to slot arg (Runtime::append)
+	Print,       // print prints[arg]
+	Read,        // read() into slot arg
+	TimeExec,    // enable timeexec
+	ProfEnter,   // --profile: statement site arg starts
+	ProfLeave,   // --profile: statement site arg ends
+	ProfEval,    // --profile: site arg evaluated its condition
+	Halt,
+};
+
+struct Instr {
+	OpCode op;
+	uint8_t aux;
+	int32_t arg;
+};
+
+struct Chunk {
+	std::vector<Instr> code;
+	std::vector<int> lines; // source line of each instruction
+	std::vector<Value> constants;
+	std::vector<ArenaArray<PrintPart>> prints; // templates; text views the program arena
+	size_t maxStack = 0;
+};
+
+const char* opCodeName(OpCode op);
+
+#endif
+
+
@@ -0,0 +1,27 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include "AST.h"
+#include "Bytecode.h"
+
+// Lowers a resolved AST into a flat Chunk for the VM.
+class Compiler {
+public:
+	Chunk compile(const BlockStmt& program);
+private:
+	void compileStmt(const Stmt& st);
+	void compileStmtBody(const Stmt& st);
+	void compileExpr(const Expr& e);
+	size_t emit(OpCode op, int32_t arg = 0, uint8_t aux = 0);
+	void patchJump(size_t at) { chunk.code[at].arg = static_cast<int32_t>(chunk.code.size()); }
+	int32_t addConstant(const Value& v);
+	void push() { if (++depth > chunk.maxStack) chunk.maxStack = depth; }
+	void pop(size_t n = 1) { depth -= n; }
+	Chunk chunk;
+	size_t depth = 0;
+	int line = 0;
+};
+
+#endif
+
+
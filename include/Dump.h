@@ -0,0 +1,12 @@
+#ifndef DUMP_H
+#define DUMP_H
+
+#include <ostream>
+#include "AST.h"
+
+// Writes an indented, one-node-per-line listing of the tree (--dump-ast).
+void dumpProgram(const BlockStmt& program, std::ostream& os);
+
+#endif
+
+
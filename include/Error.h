@@ -1,17 +1,24 @@
 #ifndef ERROR_H
 #define ERROR_H
 
+#include <ostream>
 #include <string>
 
 namespace Err {
 	void setCurrentLine(int line);
-	int getCurrentLine();
+	int getCurrentLine(); // as reported, with the line offset
+	// Added to every reported line: --repl compiles each entry from line 1
+	// and reports it at the line where the entry started.
+	void setLineOffset(int offset);
 	void print(const std::string& tag, const std::string& msg);
 	inline void parseError(const std::string& msg) { print("parse error", msg); }
 	inline void error(const std::string& msg) { print("error", msg); }
 	inline void fatal(const std::string& msg) { print("fatal", msg); }
+	// Where diagnostics go: std::cerr, or the stream given to beginThread()
+	// on this thread (--batch workers keep each record's messages apart).
+	std::ostream& stream();
+	void beginThread(std::ostream& out);
+	void endThread();
 }
 
 #endif
-
-
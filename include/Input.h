@@ -0,0 +1,27 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Lines consumed by read(). Interactive by default (std::getline on
+// std::cin); in bulk mode the whole input is mapped or read once and lines
+// are handed out as views, with no prompts and no waiting.
+namespace In {
+	// Enables bulk mode over path ("-" for stdin).
+	bool openBulk(const std::string& path, std::string& errorMsg);
+	bool isBulk();
+	// Next line without its '\n'; empty at end of input. The view is valid
+	// until the next call.
+	std::string_view readLine();
+	// Bulk input for the calling thread only, taken from text (which must
+	// stay alive) or from provider until endThread(); used by --batch
+	// workers, one record at a time, and by library contexts.
+	using Provider = std::function<std::string_view()>; // next line, "" at end
+	void beginThread(std::string_view text);
+	void beginThread(const Provider& provider);
+	void endThread();
+}
+
+#endif
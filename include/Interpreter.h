@@ -1,31 +1,88 @@
 #ifndef INTERPRETER_H
 #define INTERPRETER_H
 
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 #include "AST.h"
+#include "Arena.h"
+#include "Bytecode.h"
+#include "Jit.h"
 #include "Lexer.h"
 #include "Parser.h"
+#include "Profiler.h"
+#include "SourceBuffer.h"
+#include "Trace.h"
+#include "VM.h"
+
+enum class Engine { Tree, VM };
 
 class Interpreter{
 private:
-    VarTable vars;
-    TypeTable types;
+    SymbolTable symbols;
+    Frame frame;
     Lexer lexer;
     Parser parser;
-    bool timeExecEnabled = false;
-    struct ControlFrame { bool parentExec; bool thisExec; bool isIf; bool lastIfResult; };
-    std::vector<ControlFrame> ctrlStack;
-    bool pendingElseValid = false;
-    bool pendingElseParentExec = false;
-    bool pendingElseLastIf = false;
-    int skipDepth = 0;
+    VM vm;
+    Engine engine = Engine::Tree;
+    bool optimizeEnabled = true;
+    Jit::Mode jitMode = Jit::Mode::Off;
+    Trace trace; // phase times for timeexec and --trace
+    Arena arena; // owns every node of program
+    BlockStmt* program = nullptr;
+    Chunk chunk;
+    Profiler* profiler = nullptr;
+    std::string cacheLocation; // --cache file or directory; empty when off
+    bool cacheIsDirectory = false;
+    SourceBuffer cacheFile; // mapped cache the loaded program's names point into
+
+    // Lexes, parses, resolves and optimizes source into program.
+    bool compileSource(std::string_view source);
+    // The steps of compileSource after lexing, into any arena.
+    bool compileTokens(const std::vector<Token>& tokens, Arena& into, BlockStmt*& out);
+    // Engine-specific lowering of a checked program; sizes the frame.
+    void prepare(Arena& into, BlockStmt& prog, Chunk& code);
+    bool runCompiled(BlockStmt& prog, const Chunk& code);
 
 public:
-    bool execute(const std::string& line); // returns false on fatal error
-    bool isTimeExecEnabled() const { return timeExecEnabled; }
-    bool isReadStatement(const std::string& line);
+    void setEngine(Engine e) { engine = e; }
+    void setOptimize(bool enabled) { optimizeEnabled = enabled; }
+    // Native code for hot expressions of the tree engine (--jit).
+    void setJit(Jit::Mode mode) { jitMode = mode; }
+    // Statements compiled from now on are profiled into p (--profile).
+    void setProfiler(Profiler* p) { profiler = p; }
+    // Reuse compiled programs from location (a cache file, or a directory of
+    // caches named by source hash) and refresh it after compiling (--cache).
+    void setCache(std::string location, bool isDirectory) { cacheLocation = std::move(location); cacheIsDirectory = isDirectory; }
+    const BlockStmt* compiledProgram() const { return program; }
+    const SymbolTable& symbolTable() const { return symbols; }
+    // Source text is only referenced while compiling; the program keeps copies.
+    bool compile(std::string_view source); // returns false on parse error
+    bool run(); // returns false on fatal error
+    bool execute(std::string_view source) { return compile(source) && run(); }
+    // A compiled source that owns its nodes and bytecode, so it stays valid
+    // while other sources are compiled and run (--repl keeps many). Units
+    // share this interpreter's variables.
+    struct Unit {
+        Arena arena;
+        BlockStmt* program = nullptr;
+        Chunk chunk;
+    };
+    std::unique_ptr<Unit> compileUnit(const std::vector<Token>& tokens); // null on error
+    bool runUnit(const Unit& unit) { return runCompiled(*unit.program, unit.chunk); }
+    // Sets up f for runIn(): one entry per slot of the compiled program.
+    void initFrame(Frame& f) const;
+    // Runs the compiled program on a caller-owned frame and VM. Nothing
+    // shared is written, so several threads may do this at once (unless
+    // profiling).
+    bool runIn(Frame& f, VM& machine) const;
+    // --batch: runs the compiled program once per record of input on jobs
+    // threads; see Batch.h.
+    void runBatch(std::string_view input, unsigned jobs);
+    bool isTimeExecEnabled() const { return frame.timeExec; }
+    // Times of every compile()/run() so far, split by phase.
+    Trace& phaseTrace() { return trace; }
 };
 
 #endif
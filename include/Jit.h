@@ -0,0 +1,36 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <unordered_map>
+#include "AST.h"
+
+enum class StaticType : uint8_t; // TypeChecker.h
+
+// Native tier for the tree walker (--jit; x86-64 Linux only). The
+// TypeChecker hands it every root expression (initializer, assigned value,
+// if/while condition) together with the static type of each node; when
+// all of them are int, float or bool, the root is wrapped in a node that
+// counts its evaluations and, once hot, runs x86-64 code generated into
+// mmap'd pages instead of walking the tree. Anything else (str, unknown
+// types, float '%') stays interpreted, and so does an int '/' or '%' whose
+// divisor turns out to be 0 or -1 (the native code bails out to the tree,
+// which reports or wraps as usual). Wrapped nodes keep the kind and fields
+// of the root, so dumps see the original tree.
+namespace Jit {
+	enum class Mode {
+		Off,
+		On,     // compile roots once they are hot
+		Verify, // compile on first use and check every native result against the tree
+	};
+	bool available();
+	void wrap(Expr*& root, const std::unordered_map<const Expr*, StaticType>& types, Arena& arena, Mode mode);
+	struct Stats {
+		uint64_t compiled = 0;   // roots running natively
+		uint64_t checked = 0;    // Verify: native results compared
+		uint64_t mismatches = 0; // Verify: results that differed (reported on stderr)
+	};
+	Stats stats();
+}
+
+#endif
@@ -2,12 +2,17 @@
 #define LEXER_H
 
 #include "Token.h"
-#include <string>
+#include <string_view>
 #include <vector>
 
 class Lexer {
 public:
-	std::vector<Token> tokenize(const std::string& line);
+	// Tokenizes a whole source text; tokens carry the line they start on and
+	// view src, which must stay alive while they are used. startInComment
+	// continues a /* comment left open by a previous piece of text.
+	std::vector<Token> tokenize(std::string_view src, int firstLine = 1, bool startInComment = false);
+	// The last tokenize() ended inside a /* comment.
+	bool inComment() const { return inBlockComment; }
 private:
 	bool inBlockComment = false;
 };
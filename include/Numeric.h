@@ -0,0 +1,30 @@
+#ifndef NUMERIC_H
+#define NUMERIC_H
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Number <-> text conversions on std::from_chars/std::to_chars: no locale,
+// no exceptions, no temporary strings. Used for literals, read() and every
+// value turned into text (print, concatenation, str variables).
+namespace Numeric {
+	// The number at the start of text, after optional blanks and a '+'
+	// sign; trailing text is ignored, as with std::stoll/std::stod. False
+	// when there is no number or it is out of range.
+	bool parseInt(std::string_view text, int64_t& out);
+	bool parseFloat(std::string_view text, double& out);
+	inline void appendInt(std::string& out, int64_t v) {
+		char buf[24];
+		char* last = std::to_chars(buf, buf + sizeof buf, v).ptr;
+		out.append(buf, static_cast<size_t>(last - buf));
+	}
+	// Shortest text that reads back as exactly v: fixed notation for
+	// magnitudes in [1e-4, 1e16) with ".0" on whole numbers (2.0, 0.1,
+	// 0.30000000000000004), scientific otherwise (1e+16, 1e-05); inf, -inf
+	// and nan (-nan with the sign bit set) as they are.
+	void appendFloat(std::string& out, double v);
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef OPERATORS_H
+#define OPERATORS_H
+
+#include <cstdint>
+
+// Operators of the expression language. The parser maps tokens to these
+// once; evaluation, folding and compilation switch on the enum (or take it
+// as a template argument) instead of comparing operator text.
+enum class BinaryOp : uint8_t { Add, Sub, Mul, Div, Mod, Eq, Ne, Lt, Le, Gt, Ge, And, Or };
+enum class UnaryOp : uint8_t { Not, Neg };
+
+constexpr bool isArithmetic(BinaryOp op) { return op <= BinaryOp::Mod; }
+constexpr bool isComparison(BinaryOp op) { return op >= BinaryOp::Eq && op <= BinaryOp::Ge; }
+constexpr bool isLogical(BinaryOp op) { return op == BinaryOp::And || op == BinaryOp::Or; }
+
+// Source spelling, for dumps and error messages.
+inline const char* opSymbol(BinaryOp op) {
+	switch (op) {
+		case BinaryOp::Add: return "+";
+		case BinaryOp::Sub: return "-";
+		case BinaryOp::Mul: return "*";
+		case BinaryOp::Div: return "/";
+		case BinaryOp::Mod: return "%";
+		case BinaryOp::Eq: return "==";
+		case BinaryOp::Ne: return "!=";
+		case BinaryOp::Lt: return "<";
+		case BinaryOp::Le: return "<=";
+		case BinaryOp::Gt: return ">";
+		case BinaryOp::Ge: return ">=";
+		case BinaryOp::And: return "&&";
+		case BinaryOp::Or: return "||";
+	}
+	return "?";
+}
+
+inline const char* opSymbol(UnaryOp op) { return op == UnaryOp::Not ? "!" : "-"; }
+
+#endif
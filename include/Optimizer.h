@@ -0,0 +1,23 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "AST.h"
+
+// Folds literal subtrees, drops if/else arms with constant conditions and
+// merges adjacent prints of plain text. Runs after the Resolver; new nodes
+// are allocated in the program's arena.
+class Optimizer {
+public:
+	explicit Optimizer(Arena& arena) : arena(arena) {}
+	void optimize(BlockStmt& program) { optimizeBlock(program); }
+private:
+	void optimizeBlock(BlockStmt& block);
+	// Returns the statement that replaces st (st itself, another node or null).
+	Stmt* optimizeStmt(Stmt* st);
+	void foldExpr(Expr*& e);
+	Arena& arena;
+};
+
+#endif
+
+
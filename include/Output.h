@@ -0,0 +1,34 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Program output (print() text and read() prompts). Writes are collected in
+// a large buffer and handed to std::cout according to the flush policy;
+// diagnostics go to stderr through Err and never force a flush here.
+namespace Out {
+	enum class FlushPolicy {
+		Full,   // only when the buffer fills, before a TTY read and at exit
+		Line,   // also after every line (default when stdout is a terminal)
+		Always, // after every write (--unbuffered)
+	};
+	void setFlushPolicy(FlushPolicy policy);
+	FlushPolicy flushPolicy();
+	void write(std::string_view s);
+	void line(std::string_view s); // s followed by '\n'
+	void flush();
+	// Makes a pending prompt visible before blocking on stdin; only needed
+	// when stdin is a terminal, i.e. someone is actually typing.
+	void flushBeforeRead();
+	// Sends this thread's output to buffer or sink instead of stdout until
+	// endThread(); flushes on this thread do nothing meanwhile (--batch,
+	// library contexts).
+	using Sink = std::function<void(std::string_view text)>;
+	void beginThread(std::string& buffer);
+	void beginThread(const Sink& sink);
+	void endThread();
+}
+
+#endif
@@ -3,25 +3,41 @@
 
 #include "AST.h"
 #include "Token.h"
-#include <memory>
 #include <string>
 #include <vector>
 
 class Parser {
 public:
-	std::unique_ptr<Stmt> parseStatement(const std::vector<Token>& tokens, std::string& errorMsg);
-	void setTimeExecFlag(bool* flagPtr) { timeExecFlag = flagPtr; }
-	std::unique_ptr<Expr> parseExpr(const std::vector<Token>& tokens, size_t start, size_t end, std::string& errorMsg);
+	// Parses a whole token stream; on failure errorLine() tells where it stopped.
+	BlockStmt* parseProgram(TokenSpan tokens, std::string& errorMsg);
+	Stmt* parseStatement(TokenSpan tokens, size_t& i, std::string& errorMsg);
+	int errorLine() const { return errorLine_; }
+	// Every node and name is allocated in this arena, which owns the program.
+	void setArena(Arena* a) { arena = a; }
+	// Parses tokens[start, end) as one expression, in place.
+	Expr* parseExpr(TokenSpan tokens, size_t start, size_t end, std::string& errorMsg);
 private:
-	std::unique_ptr<Expr> parseExpression(const std::vector<Token>& t, size_t& i, std::string& errorMsg);
-	std::unique_ptr<Expr> parseLogicalOr(const std::vector<Token>& t, size_t& i, std::string& errorMsg);
-	std::unique_ptr<Expr> parseLogicalAnd(const std::vector<Token>& t, size_t& i, std::string& errorMsg);
-	std::unique_ptr<Expr> parseEquality(const std::vector<Token>& t, size_t& i, std::string& errorMsg);
-	std::unique_ptr<Expr> parseComparison(const std::vector<Token>& t, size_t& i, std::string& errorMsg);
-	std::unique_ptr<Expr> parseAdditive(const std::vector<Token>& t, size_t& i, std::string& errorMsg);
-	std::unique_ptr<Expr> parseUnary(const std::vector<Token>& t, size_t& i, std::string& errorMsg);
-	std::unique_ptr<Expr> parseTerm(const std::vector<Token>& t, size_t& i, std::string& errorMsg);
-	bool* timeExecFlag = nullptr;
+	Stmt* parseSimpleStatement(TokenSpan t, size_t& i, std::string& errorMsg);
+	Stmt* parseIf(TokenSpan t, size_t& i, std::string& errorMsg);
+	Stmt* parseWhile(TokenSpan t, size_t& i, std::string& errorMsg);
+	Stmt* parseFor(TokenSpan t, size_t& i, std::string& errorMsg);
+	Stmt* parseAssignment(TokenSpan t, size_t& i, std::string& errorMsg);
+	ArenaArray<PrintPart> splitTemplate(std::string_view content);
+	BlockStmt* finishBlock(size_t mark);
+	BlockStmt* parseBlock(TokenSpan t, size_t& i, std::string& errorMsg);
+	Expr* parseExpression(TokenSpan t, size_t& i, std::string& errorMsg);
+	Expr* parseLogicalOr(TokenSpan t, size_t& i, std::string& errorMsg);
+	Expr* parseLogicalAnd(TokenSpan t, size_t& i, std::string& errorMsg);
+	Expr* parseEquality(TokenSpan t, size_t& i, std::string& errorMsg);
+	Expr* parseComparison(TokenSpan t, size_t& i, std::string& errorMsg);
+	Expr* parseAdditive(TokenSpan t, size_t& i, std::string& errorMsg);
+	Expr* parseMultiplicative(TokenSpan t, size_t& i, std::string& errorMsg);
+	Expr* parseUnary(TokenSpan t, size_t& i, std::string& errorMsg);
+	Expr* parseTerm(TokenSpan t, size_t& i, std::string& errorMsg);
+	Arena* arena = nullptr;
+	std::vector<Stmt*> scratch; // statements of the blocks being parsed
+	std::vector<PrintPart> partScratch;
+	int errorLine_ = 0;
 };
 
 #endif
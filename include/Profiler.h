@@ -0,0 +1,69 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct Stmt;
+struct Frame;
+
+// --profile: per-statement execution counts, expression evaluations and
+// time. Every non-block statement of the program becomes a site whose
+// parent is its enclosing if/while, so the site tree is also the stack used
+// for collapsed-stack (flame graph) output.
+//
+// Counts are exact. Time is sampled: entering and leaving a site only
+// updates the current site, and a SIGALRM timer every kSampleInterval
+// charges one sample to it. Inclusive time is a site's samples plus those
+// of its children, scaled to the measured wall time of the run.
+class Profiler {
+public:
+	static constexpr std::chrono::microseconds kSampleInterval{100};
+
+	// Assigns Stmt::site to the statements of a resolved, optimized program.
+	void registerProgram(Stmt& program);
+	void start();
+	void stop();
+
+	void enter(int site) {
+		Site& s = sites[site];
+		s.count++;
+		s.evals += s.evalsPerRun;
+		current = site;
+	}
+	void leave(int site) { current = sites[site].parent; }
+	void countEval(int site) { sites[site].evals++; }
+	// Runs st (which must have a site) and records it.
+	bool execute(Stmt& st, Frame& frame);
+
+	// Hot-spot table sorted by self time.
+	void report(std::ostream& os) const;
+	// One "program;outer@line;inner@line self_us" line per site.
+	bool writeCollapsed(const std::string& path, std::string& errorMsg) const;
+
+private:
+	struct Site {
+		const char* what;
+		int line;
+		int parent;          // enclosing site, -1 at top level
+		uint8_t evalsPerRun; // expressions evaluated by every execution
+		uint64_t count = 0;
+		uint64_t evals = 0;
+		uint64_t hits = 0;   // timer samples taken while this was the current site
+	};
+	static void onSample(int);
+	void registerStmt(Stmt& st, int parent);
+	std::vector<uint64_t> inclusiveHits() const;
+	double hitsToMs(uint64_t hits) const;
+	std::vector<Site> sites;
+	volatile std::sig_atomic_t current = -1;
+	uint64_t rootHits = 0; // samples outside any statement
+	std::chrono::steady_clock::time_point wallStart;
+	double totalMs = 0;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Embedding API (build/libprog.a, build/libprog.so): a host process
+// compiles a script once and runs it as often as it likes, without stdin,
+// stdout or a process per run.
+//   Program  the compiled script. Immutable once compile() returns, so any
+//            number of threads may run it at the same time.
+//   Context  the state of one execution: variables, the source of read()
+//            lines and the destination of print() text. Reusable, but used
+//            by one thread at a time.
+// Only standard headers are included and both classes hold their state
+// behind an Impl pointer, so internal changes keep libprog.so's ABI.
+class Program {
+public:
+	enum class Engine { Tree, VM };
+	enum class JitMode {
+		Off,
+		On,     // compile hot expressions to native code
+		Verify, // compile on first use and check every native result
+	};
+	struct Options {
+		Engine engine = Engine::Tree;
+		bool optimize = true;
+		JitMode jit = JitMode::Off; // tree engine only; ignored where there is no JIT
+	};
+	// Null on a compile error; errorMsg then holds the diagnostics, e.g.
+	// "[parse error] line 3: expected ';'".
+	static std::unique_ptr<Program> compile(std::string_view source, std::string& errorMsg);
+	static std::unique_ptr<Program> compile(std::string_view source, const Options& options, std::string& errorMsg);
+	Program(const Program&) = delete;
+	Program& operator=(const Program&) = delete;
+	~Program();
+private:
+	Program();
+	friend class Context;
+	struct Impl;
+	std::unique_ptr<Impl> impl;
+};
+
+class Context {
+public:
+	// Next line for read() into line; false at the end of the input, after
+	// which read() sees an empty line.
+	using Input = std::function<bool(std::string& line)>;
+	// print() text, in pieces; a line ends with a "\n" piece.
+	using Output = std::function<void(std::string_view text)>;
+
+	explicit Context(const Program& program);
+	Context(const Context&) = delete;
+	Context& operator=(const Context&) = delete;
+	~Context();
+	void setInput(Input in);   // default: no input
+	void setOutput(Output out); // default: discarded
+	// Runs the program from the start with every variable undeclared.
+	// Returns false on a fatal error; diagnostics of the run are in errors().
+	bool run();
+	const std::string& errors() const;
+	bool timeExecRequested() const;
+	// Text of a variable after run() (as print() shows it); false when the
+	// program has no such variable or its declaration did not run.
+	bool variable(std::string_view name, std::string& text) const;
+private:
+	struct Impl;
+	std::unique_ptr<Impl> impl;
+};
+
+#endif
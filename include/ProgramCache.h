@@ -0,0 +1,32 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "AST.h"
+#include "SourceBuffer.h"
+
+// On-disk copy of a compiled program (--cache): the resolved and optimized
+// AST plus its symbol table and strings, keyed by a hash of the source.
+// A later run maps the file and rebuilds the tree in the arena without
+// lexing, parsing, resolving or optimizing; names and print text keep
+// pointing into the mapping. Any mismatch (format version,
+// source hash, optimizer setting, checksum, truncated data) makes load()
+// fail so the caller compiles from source instead.
+namespace ProgramCache {
+	uint64_t hashSource(std::string_view source);
+	// "<dir>/<16 hex digits of hash>.bpc", or "...-noopt.bpc" for --no-opt
+	std::string pathInDir(const std::string& dir, uint64_t sourceHash, bool optimized);
+	// Written to a temporary file and renamed, so concurrent runs never see a
+	// partial cache.
+	bool save(const std::string& path, uint64_t sourceHash, bool optimized, const BlockStmt& program,
+		const SymbolTable& symbols, std::string& errorMsg);
+	// Returns null (with errorMsg set) when the cache is missing, stale or
+	// corrupt. file receives the mapping and must outlive the program;
+	// symbols must be empty.
+	BlockStmt* load(const std::string& path, uint64_t sourceHash, bool optimized, SourceBuffer& file,
+		Arena& arena, SymbolTable& symbols, std::string& errorMsg);
+}
+
+#endif
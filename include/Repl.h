@@ -0,0 +1,72 @@
+#ifndef REPL_H
+#define REPL_H
+
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Interpreter.h"
+
+// --repl: reads statements from a stream and runs each entry as soon as it
+// is complete, with variables kept from one entry to the next. An entry
+// continues over several lines while a '{' or '(' is open, a /* comment is
+// unterminated or the last statement lacks its ';'; after the '}' of an if
+// it waits for a possible else (a blank line ends it). Lines starting with
+// ':' are commands: ":stats" prints the cache counters, ":quit" exits.
+//
+// Compiled entries are kept in an LRU cache keyed by their token stream
+// (type and text of every token, so spacing, comments and line breaks do
+// not matter): an entry seen before skips parse, resolve, type check,
+// optimize and bytecode compile. Entries that fail to compile are not
+// cached.
+class Repl {
+public:
+	static constexpr size_t kDefaultCapacity = 256;
+	explicit Repl(Interpreter& interp, size_t capacity = kDefaultCapacity) : interp(interp), capacity(capacity) {}
+	// Prompts (">>> ", "... ") are written only when prompt is set.
+	void run(std::istream& in, bool prompt);
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		size_t size = 0;
+		size_t capacity = 0;
+	};
+	Stats stats() const { return {hits, misses, lru.size(), capacity}; }
+private:
+	enum class Shape { Incomplete, Complete, CompleteIf };
+	// The entry being typed. Each line is lexed once, when it is added,
+	// carrying the nesting and comment state over from the previous ones;
+	// its tokens, numbered from the entry's first line, are what submit()
+	// keys and compiles.
+	struct Pending {
+		std::deque<std::string> lines; // stable storage for the token lexemes
+		std::vector<Token> tokens; // without EndOfInput
+		int firstLine = 0;
+		int depth = 0; // '{' and '(' still open
+		bool inComment = false;
+		bool lastIsIf = false; // the last top-level statement is an if with no final else yet
+		TokenType lastType = TokenType::EndOfInput;
+	};
+	Shape addLine(const std::string& line, int lineNo);
+	void submit();
+	bool command(std::string_view line); // false for ":quit"
+
+	struct Entry {
+		std::string key;
+		std::unique_ptr<Interpreter::Unit> unit;
+	};
+	Interpreter& interp;
+	size_t capacity;
+	std::list<Entry> lru; // most recently used first
+	std::unordered_map<std::string_view, std::list<Entry>::iterator> index; // views Entry::key
+	Pending pending;
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+};
+
+#endif
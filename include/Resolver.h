@@ -0,0 +1,23 @@
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include "AST.h"
+
+// Assigns every variable name in a program a dense slot index so that the
+// runtime can keep variables in a flat Frame instead of hash maps. Also
+// rejects print() placeholders naming a variable that is never declared
+// before them; on failure errorLine() tells where.
+class Resolver {
+public:
+	explicit Resolver(SymbolTable& symbols) : symbols(symbols) {}
+	bool resolve(Stmt& st, std::string& errorMsg);
+	int errorLine() const { return errorLine_; }
+private:
+	void resolveExpr(Expr& e);
+	SymbolTable& symbols;
+	int errorLine_ = 0;
+};
+
+#endif
+
+
@@ -0,0 +1,36 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <string>
+#include <string_view>
+#include "AST.h"
+
+// Statement semantics shared by the tree walker and the bytecode VM, so both
+// engines produce the same values, output and diagnostics.
+namespace Runtime {
+	Value defaultValue(VarType type);
+	Value undefinedValue();
+	inline Value load(const Frame& frame, int slot) {
+		if (frame.types[slot] == VarType::Undeclared) return undefinedValue();
+		return frame.values[slot];
+	}
+	// Each returns false (after printing the diagnostic) on a fatal error.
+	bool declare(Frame& frame, int slot, VarType declType, Value value);
+	bool assign(Frame& frame, int slot, Value value);
+	bool read(Frame& frame, int slot);
+	void print(const Frame& frame, const ArenaArray<PrintPart>& parts);
+	// 'slot = slot + tails[0] + ... + tails[count - 1]' for an assignment
+	// marked appendsInPlace: a str variable that holds the only reference to
+	// its text is appended to in place; anything else is computed as usual.
+	bool append(Frame& frame, int slot, const Value* tails, int count);
+	// '+' (fatal when a str would exceed StrObj::kMaxSize), arithmetic ('-',
+	// '*', '/', '%') and unary '-'; false after printing the diagnostic when
+	// an operand is not a number or an int is divided by 0.
+	bool add(const Value& l, const Value& r, Value& out);
+	bool arith(BinaryOp op, const Value& l, const Value& r, Value& out);
+	bool negate(const Value& v, Value& out);
+}
+
+#endif
+
+
@@ -0,0 +1,30 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <string>
+#include <string_view>
+
+// Read-only program text. Files are memory-mapped; stdin (path "-") and
+// anything that cannot be mapped is read once into an owned string. Tokens
+// keep views into this buffer, so it must outlive lexing and parsing.
+class SourceBuffer {
+public:
+	SourceBuffer() = default;
+	SourceBuffer(const SourceBuffer&) = delete;
+	SourceBuffer& operator=(const SourceBuffer&) = delete;
+	~SourceBuffer() { close(); }
+
+	bool open(const std::string& path, std::string& errorMsg);
+	std::string_view view() const { return mapped ? std::string_view(mapped, mappedSize) : std::string_view(owned); }
+	void close();
+
+private:
+	bool readAll(int fd, std::string& errorMsg);
+	const char* mapped = nullptr;
+	size_t mappedSize = 0;
+	std::string owned;
+};
+
+#endif
+
+
@@ -1,9 +1,11 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
-#include <string>
+#include <cstddef>
+#include <string_view>
+#include <vector>
 
-enum class TokenType {
+enum class TokenType : unsigned char {
 	Identifier,
 	IntLiteral,
 	FloatLiteral,
@@ -17,6 +19,8 @@ enum class TokenType {
 	KeywordIf,
 	KeywordElse,
 	KeywordTimeExec,
+	KeywordWhile,
+	KeywordFor,
 	LParen,
 	RParen,
 	LBrace,
@@ -34,13 +38,43 @@ enum class TokenType {
 	Semicolon,
 	Comma,
 	Plus,
+	Minus,
+	Star,
+	Slash,
+	Percent,
+	PlusPlus,
+	MinusMinus,
+	PlusEqual,
+	MinusEqual,
+	StarEqual,
+	SlashEqual,
+	PercentEqual,
 	EndOfInput,
 	Unknown
 };
 
+// lexeme views the source text the token was read from (see SourceBuffer).
 struct Token {
 	TokenType type;
-	std::string lexeme;
+	std::string_view lexeme;
+	int line = 0;
+};
+
+// Non-owning view of a run of tokens inside one token buffer; the parser
+// walks spans by index instead of copying tokens into sub-vectors.
+struct TokenSpan {
+	const Token* data = nullptr;
+	size_t count = 0;
+	TokenSpan() = default;
+	TokenSpan(const Token* d, size_t n) : data(d), count(n) {}
+	TokenSpan(const std::vector<Token>& tokens) : data(tokens.data()), count(tokens.size()) {}
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	const Token& operator[](size_t i) const { return data[i]; }
+	const Token* begin() const { return data; }
+	const Token* end() const { return data + count; }
+	// Tokens [start, end) of this span.
+	TokenSpan sub(size_t start, size_t end) const { return TokenSpan(data + start, end - start); }
 };
 
 #endif
@@ -0,0 +1,51 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Interpreter phases timed on steady_clock for timeexec() and --trace.
+enum class Phase { Cache, Lex, Parse, Resolve, TypeCheck, Optimize, Compile, Execute, InputWait, Count };
+
+const char* phaseName(Phase phase);
+
+// Accumulates the time spent in each phase. With spans enabled (--trace)
+// it also keeps every individual span, to be written in Chrome trace-event
+// format for Perfetto / chrome://tracing.
+class Trace {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	void enableSpans() { keepSpans = true; }
+	void add(Phase phase, Clock::time_point start, Clock::time_point end) {
+		totals[static_cast<int>(phase)] += end - start;
+		if (keepSpans) spans.push_back({phase, start, end});
+	}
+	Clock::duration total(Phase phase) const { return totals[static_cast<int>(phase)]; }
+	// Sum of the phases the interpreter itself runs, i.e. without input wait.
+	Clock::duration busyTotal() const;
+	bool writeChrome(const std::string& path, std::string& errorMsg) const;
+
+private:
+	struct Span { Phase phase; Clock::time_point start, end; };
+	Clock::duration totals[static_cast<int>(Phase::Count)] = {};
+	std::vector<Span> spans;
+	bool keepSpans = false;
+	Clock::time_point origin = Clock::now();
+};
+
+// Adds the time until the end of the enclosing scope to one phase.
+class PhaseScope {
+public:
+	PhaseScope(Trace& trace, Phase phase) : trace(trace), phase(phase), start(Trace::Clock::now()) {}
+	~PhaseScope() { trace.add(phase, start, Trace::Clock::now()); }
+	PhaseScope(const PhaseScope&) = delete;
+	PhaseScope& operator=(const PhaseScope&) = delete;
+private:
+	Trace& trace;
+	Phase phase;
+	Trace::Clock::time_point start;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TYPE_CHECKER_H
+#define TYPE_CHECKER_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "AST.h"
+#include "Jit.h"
+
+// Static type of an expression; Unknown when it depends on the run (e.g. a
+// variable whose declaration may not have executed yet).
+enum class StaticType : uint8_t { Unknown, Int, Float, Bool, Str };
+
+// Infers expression types from declarations, following statements in
+// order: a variable has a known type only where its declaration has
+// certainly run. Runs after the Resolver.
+//   check()      rejects statements that are certain to fail at runtime with
+//                a type mismatch (e.g. int z = "abc"), before execution.
+//   specialize() replaces binary nodes whose operand types are known with
+//                the typed nodes of TypedExpr.h; run it on the final
+//                (optimized or cached) tree. With a Jit mode other than
+//                Off it also hands each root expression to Jit::wrap().
+class TypeChecker {
+public:
+	TypeChecker(const SymbolTable& symbols, Arena& arena) : symbols(symbols), arena(arena) {}
+	bool check(BlockStmt& program, std::string& errorMsg);
+	void specialize(BlockStmt& program, Jit::Mode jit = Jit::Mode::Off);
+	int errorLine() const { return errorLine_; }
+private:
+	bool walk(Stmt& st);
+	StaticType typeOf(Expr*& e);
+	StaticType inferType(Expr*& e);
+	StaticType typeOfRoot(Expr*& e);
+	Expr* lower(BinaryExpr& bin, StaticType l, StaticType r);
+	bool fail(int line, std::string msg);
+	bool checkStore(int line, VarType target, StaticType value);
+	// Known slot types change through set() so branches can be undone.
+	void set(int slot, StaticType type);
+	void rollback(size_t mark);
+	std::vector<std::pair<int, StaticType>> changesSince(size_t mark) const;
+	void collectDeclared(const Stmt& st, std::vector<int>& slots) const;
+
+	const SymbolTable& symbols;
+	Arena& arena;
+	bool lowering = false;
+	Jit::Mode jitMode = Jit::Mode::Off;
+	std::unordered_map<const Expr*, StaticType> exprTypes; // of the current root, for the Jit
+	int skippable = 0; // inside the right operand of && or ||
+	std::vector<StaticType> slotTypes;
+	std::vector<std::pair<int, StaticType>> undoLog; // (slot, previous type)
+	std::string* errorMsg = nullptr;
+	int errorLine_ = 0;
+};
+
+#endif
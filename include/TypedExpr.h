@@ -0,0 +1,119 @@
+#ifndef TYPED_EXPR_H
+#define TYPED_EXPR_H
+
+#include <cmath>
+#include "AST.h"
+#include "Runtime.h"
+
+// Binary nodes the TypeChecker substitutes once both operand types are
+// known. They keep BinaryExpr's kind and fields, so every other pass (VM
+// compiler, dump, cache) still sees a plain BinaryExpr; only evaluate()
+// skips the runtime type checks.
+namespace TypedOps {
+	struct Add {
+		static int64_t apply(int64_t a, int64_t b) { return wrapAdd(a, b); }
+		static double apply(double a, double b) { return a + b; }
+	};
+	struct Sub {
+		static int64_t apply(int64_t a, int64_t b) { return wrapSub(a, b); }
+		static double apply(double a, double b) { return a - b; }
+	};
+	struct Mul {
+		static int64_t apply(int64_t a, int64_t b) { return wrapMul(a, b); }
+		static double apply(double a, double b) { return a * b; }
+	};
+	// Int division never sees 0 or -1 here; IntDivExpr sends those to Runtime.
+	struct Div {
+		static constexpr BinaryOp op = BinaryOp::Div;
+		static int64_t apply(int64_t a, int64_t b) { return a / b; }
+		static double apply(double a, double b) { return a / b; }
+	};
+	struct Mod {
+		static constexpr BinaryOp op = BinaryOp::Mod;
+		static int64_t apply(int64_t a, int64_t b) { return a % b; }
+		static double apply(double a, double b) { return std::fmod(a, b); }
+	};
+}
+
+// int op int for '+', '-', '*'.
+template <typename Op>
+struct IntArithExpr final : BinaryExpr {
+	using BinaryExpr::BinaryExpr;
+	Value evaluate(Frame& frame) override {
+		int64_t a = left->evaluate(frame).intValue();
+		int64_t b = right->evaluate(frame).intValue();
+		return Value::fromInt(Op::apply(a, b));
+	}
+};
+
+// int '/' and '%'; a divisor of 0 (error) or -1 (wrap-around) takes the
+// generic path.
+template <typename Op>
+struct IntDivExpr final : BinaryExpr {
+	using BinaryExpr::BinaryExpr;
+	Value evaluate(Frame& frame) override {
+		Value l = left->evaluate(frame);
+		Value r = right->evaluate(frame);
+		int64_t b = r.intValue();
+		if (b != 0 && b != -1) return Value::fromInt(Op::apply(l.intValue(), b));
+		Value out;
+		if (!Runtime::arith(Op::op, l, r, out)) frame.fault = true;
+		return out;
+	}
+};
+
+// Arithmetic with at least one float operand; the other may be an int.
+template <typename Op>
+struct FloatArithExpr final : BinaryExpr {
+	using BinaryExpr::BinaryExpr;
+	Value evaluate(Frame& frame) override {
+		double a = left->evaluate(frame).asFloat();
+		double b = right->evaluate(frame).asFloat();
+		return Value::fromFloat(Op::apply(a, b));
+	}
+};
+
+// Comparisons take a standard functor (std::less<> etc.).
+template <typename Cmp>
+struct IntCompareExpr final : BinaryExpr {
+	using BinaryExpr::BinaryExpr;
+	Value evaluate(Frame& frame) override {
+		int64_t a = left->evaluate(frame).intValue();
+		int64_t b = right->evaluate(frame).intValue();
+		return Value::fromBool(Cmp()(a, b));
+	}
+};
+
+template <typename Cmp>
+struct FloatCompareExpr final : BinaryExpr {
+	using BinaryExpr::BinaryExpr;
+	Value evaluate(Frame& frame) override {
+		double a = left->evaluate(frame).asFloat();
+		double b = right->evaluate(frame).asFloat();
+		return Value::fromBool(Cmp()(a, b));
+	}
+};
+
+template <typename Cmp>
+struct StrCompareExpr final : BinaryExpr {
+	using BinaryExpr::BinaryExpr;
+	Value evaluate(Frame& frame) override {
+		Value l = left->evaluate(frame);
+		Value r = right->evaluate(frame);
+		return Value::fromBool(Cmp()(l.asStr(), r.asStr()));
+	}
+};
+
+// '+' with a str on either side: the other operand is appended as text.
+struct StrConcatExpr final : BinaryExpr {
+	using BinaryExpr::BinaryExpr;
+	Value evaluate(Frame& frame) override {
+		Value l = left->evaluate(frame);
+		Value r = right->evaluate(frame);
+		Value out;
+		if (!Runtime::add(l, r, out)) frame.fault = true;
+		return out;
+	}
+};
+
+#endif
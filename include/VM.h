@@ -0,0 +1,17 @@
+#ifndef VM_H
+#define VM_H
+
+#include <vector>
+#include "AST.h"
+#include "Bytecode.h"
+
+class VM {
+public:
+	bool run(const Chunk& chunk, Frame& frame); // returns false on fatal error
+private:
+	std::vector<Value> stack;
+};
+
+#endif
+
+
@@ -0,0 +1,128 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "Operators.h"
+
+enum class ValueKind : uint8_t { Int, Float, Bool, Str };
+
+// Reference-counted string payload shared by copies of a str Value.
+// Immortal payloads belong to someone else (e.g. literals in an Arena) and
+// are never counted or freed through a Value.
+struct StrObj {
+	static constexpr uint32_t kImmortal = UINT32_MAX;
+	// Longest text a str may hold; longer results are a fatal error.
+	static constexpr size_t kMaxSize = size_t(256) << 20;
+	uint32_t refs;
+	std::string data;
+	explicit StrObj(std::string s, uint32_t r = 1) : refs(r), data(std::move(s)) {}
+};
+
+// Tagged runtime value: 16 bytes, no allocation for int/float/bool.
+class Value {
+public:
+	Value() : kind_(ValueKind::Int) { p_.i = 0; }
+	static Value fromInt(int64_t v) { Value r; r.kind_ = ValueKind::Int; r.p_.i = v; return r; }
+	static Value fromFloat(double v) { Value r; r.kind_ = ValueKind::Float; r.p_.f = v; return r; }
+	static Value fromBool(bool v) { Value r; r.kind_ = ValueKind::Bool; r.p_.b = v; return r; }
+	static Value fromStr(std::string s) { Value r; r.kind_ = ValueKind::Str; r.p_.s = new StrObj(std::move(s)); return r; }
+	static Value fromImmortalStr(StrObj* s) { Value r; r.kind_ = ValueKind::Str; r.p_.s = s; return r; }
+
+	Value(const Value& o) : kind_(o.kind_), p_(o.p_) { retain(); }
+	Value(Value&& o) noexcept : kind_(o.kind_), p_(o.p_) { o.kind_ = ValueKind::Int; o.p_.i = 0; }
+	Value& operator=(const Value& o) {
+		if (this != &o) { o.retain(); release(); kind_ = o.kind_; p_ = o.p_; }
+		return *this;
+	}
+	Value& operator=(Value&& o) noexcept {
+		if (this != &o) { release(); kind_ = o.kind_; p_ = o.p_; o.kind_ = ValueKind::Int; o.p_.i = 0; }
+		return *this;
+	}
+	~Value() { release(); }
+
+	ValueKind kind() const { return kind_; }
+	bool isStr() const { return kind_ == ValueKind::Str; }
+	bool isImmortalStr() const { return kind_ == ValueKind::Str && p_.s->refs == StrObj::kImmortal; }
+	bool isNumeric() const { return kind_ != ValueKind::Str; }
+	bool isInt() const { return kind_ == ValueKind::Int; }
+	// Raw payload for the VM's int fast paths. Only valid when isInt().
+	int64_t intValue() const { return p_.i; }
+
+	// Numeric views; bool counts as 0/1. Only valid when isNumeric().
+	int64_t asInt() const { return kind_ == ValueKind::Float ? static_cast<int64_t>(p_.f) : (kind_ == ValueKind::Bool ? p_.b : p_.i); }
+	double asFloat() const { return kind_ == ValueKind::Float ? p_.f : static_cast<double>(asInt()); }
+	const std::string& asStr() const { return p_.s->data; }
+	// Text that only this Value references, so it may be changed in place
+	// (appending to a variable); null for other kinds or shared text.
+	std::string* uniqueStr() { return kind_ == ValueKind::Str && p_.s->refs == 1 ? &p_.s->data : nullptr; }
+
+	bool truthy() const {
+		switch (kind_) {
+			case ValueKind::Int: return p_.i != 0;
+			case ValueKind::Float: return p_.f != 0.0;
+			case ValueKind::Bool: return p_.b;
+			case ValueKind::Str: return !p_.s->data.empty();
+		}
+		return false;
+	}
+	std::string toString() const;
+	void appendTo(std::string& out) const;
+	// Where the payload sits inside a Value, for generated code (Jit.cpp).
+	static constexpr size_t payloadOffset();
+
+private:
+	void retain() const { if (kind_ == ValueKind::Str && p_.s->refs != StrObj::kImmortal) ++p_.s->refs; }
+	void release() { if (kind_ == ValueKind::Str && p_.s->refs != StrObj::kImmortal && --p_.s->refs == 0) delete p_.s; }
+
+	union Payload {
+		int64_t i;
+		double f;
+		bool b;
+		StrObj* s;
+	};
+	ValueKind kind_;
+	Payload p_;
+};
+
+constexpr size_t Value::payloadOffset() { return offsetof(Value, p_); }
+
+// Int arithmetic wraps around on overflow instead of invoking undefined
+// behaviour.
+inline int64_t wrapAdd(int64_t a, int64_t b) {
+	return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+inline int64_t wrapSub(int64_t a, int64_t b) {
+	return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+inline int64_t wrapMul(int64_t a, int64_t b) {
+	return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+}
+
+enum class ArithError { None, NotNumber, DivisionByZero, StrTooLong };
+// Arithmetic/concatenation for '+': numbers add, anything else concatenates
+// (StrTooLong beyond StrObj::kMaxSize).
+ArithError addValues(const Value& l, const Value& r, Value& out);
+// '-', '*', '/', '%' on numbers: float if either side is float, otherwise
+// int with wrap-around; int '/' and '%' truncate toward zero.
+ArithError arithValues(BinaryOp op, const Value& l, const Value& r, Value& out);
+// Unary '-'.
+ArithError negateValue(const Value& v, Value& out);
+// Comparison with cmp (std::less<> etc.): numbers compare numerically, two
+// strings lexicographically, mixed operands by their text.
+template <typename Cmp>
+bool compareValuesWith(const Value& l, const Value& r, Cmp cmp) {
+	if (l.isNumeric() && r.isNumeric()) {
+		if (l.kind() == ValueKind::Float || r.kind() == ValueKind::Float) return cmp(l.asFloat(), r.asFloat());
+		return cmp(l.asInt(), r.asInt());
+	}
+	if (l.isStr() && r.isStr()) return cmp(l.asStr(), r.asStr());
+	return cmp(l.toString(), r.toString());
+}
+// Same for a comparison operator known only at run time.
+bool compareValues(BinaryOp op, const Value& l, const Value& r);
+
+#endif
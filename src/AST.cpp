@@ -1,195 +1,211 @@
 #include "AST.h"
-#include <iostream>
-#include <cctype>
+#include "Error.h"
+#include "Profiler.h"
+#include "Runtime.h"
+#include <algorithm>
+#include <functional>
 
-static bool isAllDigits(const std::string& s) {
-	if (s.empty()) return false;
-	for (char c : s) if (!std::isdigit(static_cast<unsigned char>(c))) return false;
-	return true;
+void SymbolTable::indexPending() {
+	for (size_t i = slots.size(); i < names.size(); ++i) slots.emplace(names[i], static_cast<int>(i));
 }
 
-static bool isNumber(const std::string& s) {
-	if (s.empty()) return false;
-	bool hasDot = false;
-	for (char c : s) {
-		if (c == '.') { if (hasDot) return false; hasDot = true; continue; }
-		if (!std::isdigit(static_cast<unsigned char>(c))) return false;
-	}
-	return true;
+int SymbolTable::intern(std::string_view name) {
+	indexPending();
+	std::string key(name);
+	auto it = slots.find(key);
+	if (it != slots.end()) return it->second;
+	int slot = static_cast<int>(names.size());
+	names.push_back(key);
+	declared.push_back(false);
+	slots.emplace(std::move(key), slot);
+	return slot;
 }
 
-std::string IdentifierExpr::evaluate(VarTable& vars, TypeTable& /*types*/) {
-	auto it = vars.find(name);
-	return it != vars.end() ? it->second : std::string("undefined");
-}
-
-std::string UnaryExpr::evaluate(VarTable& vars, TypeTable& types) {
-	std::string v = expr->evaluate(vars, types);
-	auto truthy = [&](const std::string& s){
-		if (s.empty()) return false;
-		bool hasDot = false; bool isNum = true;
-		for (char c : s) { if (c == '.') { if (hasDot) { isNum=false; break; } hasDot=true; } else if (!std::isdigit(static_cast<unsigned char>(c))) { isNum=false; break; } }
-		if (isNum) { try { return std::stod(s) != 0.0; } catch (...) { return false; } }
-		return true;
-	};
-	if (op == "!") return truthy(v) ? std::string("0") : std::string("1");
-	return v;
-}
-
-std::string BinaryExpr::evaluate(VarTable& vars, TypeTable& types) {
-	std::string l = left->evaluate(vars, types);
-	std::string r = right->evaluate(vars, types);
-	if (op == "+") {
-		bool leftIsNum = isNumber(l);
-		bool rightIsNum = isNumber(r);
-		if (leftIsNum && rightIsNum) {
-			if (l.find('.') != std::string::npos || r.find('.') != std::string::npos) {
-				double a = 0, b = 0;
-				try { a = std::stod(l); } catch (...) { a = 0; }
-				try { b = std::stod(r); } catch (...) { b = 0; }
-				return std::to_string(a + b);
+int SymbolTable::lookup(std::string_view name) {
+	indexPending();
+	auto it = slots.find(std::string(name));
+	return it != slots.end() ? it->second : -1;
+}
+
+void SymbolTable::truncate(size_t n, std::vector<bool> declaredBefore) {
+	for (size_t i = n; i < names.size(); ++i) slots.erase(names[i]);
+	names.resize(n);
+	declared = std::move(declaredBefore);
+}
+
+Value IdentifierExpr::evaluate(Frame& frame) {
+	return Runtime::load(frame, slot);
+}
+
+namespace {
+
+template <BinaryOp Op> struct Comparator;
+template <> struct Comparator<BinaryOp::Eq> { using type = std::equal_to<>; };
+template <> struct Comparator<BinaryOp::Ne> { using type = std::not_equal_to<>; };
+template <> struct Comparator<BinaryOp::Lt> { using type = std::less<>; };
+template <> struct Comparator<BinaryOp::Le> { using type = std::less_equal<>; };
+template <> struct Comparator<BinaryOp::Gt> { using type = std::greater<>; };
+template <> struct Comparator<BinaryOp::Ge> { using type = std::greater_equal<>; };
+
+// One class per operator: evaluate() is instantiated for a single Op, so it
+// neither dispatches on the operator nor calls through to the comparison.
+template <BinaryOp Op>
+struct OpExpr final : BinaryExpr {
+	OpExpr(Expr* l, Expr* r) : BinaryExpr(Op, l, r) {}
+	Value evaluate(Frame& frame) override {
+		if constexpr (isLogical(Op)) {
+			constexpr bool decisive = Op == BinaryOp::Or;
+			if (left->evaluate(frame).truthy() == decisive || frame.fault) return Value::fromBool(decisive);
+			return Value::fromBool(right->evaluate(frame).truthy());
+		} else {
+			Value l = left->evaluate(frame);
+			Value r = right->evaluate(frame);
+			if constexpr (isArithmetic(Op)) {
+				Value out;
+				bool ok = Op == BinaryOp::Add ? Runtime::add(l, r, out) : Runtime::arith(Op, l, r, out);
+				if (!ok) frame.fault = true;
+				return out;
 			} else {
-				long long a = 0, b = 0;
-				try { a = std::stoll(l); } catch (...) { a = 0; }
-				try { b = std::stoll(r); } catch (...) { b = 0; }
-				return std::to_string(a + b);
+				return Value::fromBool(compareValuesWith(l, r, typename Comparator<Op>::type()));
 			}
 		}
-		return l + r;
 	}
-	auto cmpAsNum = [&](auto f)->std::string{
-		double a=0,b=0; try{a=std::stod(l);}catch(...){a=0;} try{b=std::stod(r);}catch(...){b=0;}
-		return f(a,b) ? std::string("1") : std::string("0");
-	};
-	auto cmpAsStr = [&](auto f)->std::string{
-		return f(l,r) ? std::string("1") : std::string("0");
-	};
-	bool bothNum = isNumber(l) && isNumber(r);
-	if (op == "==") return bothNum ? cmpAsNum([](double a,double b){return a==b;}) : cmpAsStr([](const std::string&a,const std::string&b){return a==b;});
-	if (op == "!=") return bothNum ? cmpAsNum([](double a,double b){return a!=b;}) : cmpAsStr([](const std::string&a,const std::string&b){return a!=b;});
-	if (op == "<")  return bothNum ? cmpAsNum([](double a,double b){return a<b;})  : cmpAsStr([](const std::string&a,const std::string&b){return a<b;});
-	if (op == "<=") return bothNum ? cmpAsNum([](double a,double b){return a<=b;}) : cmpAsStr([](const std::string&a,const std::string&b){return a<=b;});
-	if (op == ">")  return bothNum ? cmpAsNum([](double a,double b){return a>b;})  : cmpAsStr([](const std::string&a,const std::string&b){return a>b;});
-	if (op == ">=") return bothNum ? cmpAsNum([](double a,double b){return a>=b;}) : cmpAsStr([](const std::string&a,const std::string&b){return a>=b;});
-	if (op == "&&" || op == "||") {
-		auto truthy = [&](const std::string& s){
-			if (s.empty()) return false;
-			bool hasDot=false; bool isNum=true;
-			for (char c : s) { if (c=='.'){ if(hasDot){isNum=false; break;} hasDot=true;} else if(!std::isdigit(static_cast<unsigned char>(c))) { isNum=false; break; } }
-			if (isNum) { try { return std::stod(s)!=0.0; } catch(...) { return false; } }
-			return true;
-		};
-		bool L = truthy(l), R = truthy(r);
-		bool res = (op == "&&") ? (L && R) : (L || R);
-		return res ? std::string("1") : std::string("0");
+};
+
+struct NotExpr final : UnaryExpr {
+	explicit NotExpr(Expr* e) : UnaryExpr(UnaryOp::Not, e) {}
+	Value evaluate(Frame& frame) override { return Value::fromBool(!expr->evaluate(frame).truthy()); }
+};
+
+struct NegExpr final : UnaryExpr {
+	explicit NegExpr(Expr* e) : UnaryExpr(UnaryOp::Neg, e) {}
+	Value evaluate(Frame& frame) override {
+		Value out;
+		if (!Runtime::negate(expr->evaluate(frame), out)) frame.fault = true;
+		return out;
 	}
-	return "";
+};
+
 }
 
-bool VarDeclStmt::execute(VarTable& vars, TypeTable& types) {
-	std::string value;
-	if (initExpr) {
-		value = initExpr->evaluate(vars, types);
-		if (typeName == "int" && !isAllDigits(value)) {
-			std::cout << "[fatal] type mismatch: cannot assign string to int" << std::endl;
-			return false;
-		}
-		if (typeName == "float" && !isNumber(value)) {
-			std::cout << "[fatal] type mismatch: cannot assign non-number to float" << std::endl;
-			return false;
-		}
-	} else {
-		if (typeName == "int") value = "0";
-		else if (typeName == "float") value = "0.0";
-		else value = std::string("");
+BinaryExpr* makeBinary(Arena& arena, BinaryOp op, Expr* left, Expr* right) {
+	switch (op) {
+		case BinaryOp::Add: return arena.make<OpExpr<BinaryOp::Add>>(left, right);
+		case BinaryOp::Sub: return arena.make<OpExpr<BinaryOp::Sub>>(left, right);
+		case BinaryOp::Mul: return arena.make<OpExpr<BinaryOp::Mul>>(left, right);
+		case BinaryOp::Div: return arena.make<OpExpr<BinaryOp::Div>>(left, right);
+		case BinaryOp::Mod: return arena.make<OpExpr<BinaryOp::Mod>>(left, right);
+		case BinaryOp::Eq: return arena.make<OpExpr<BinaryOp::Eq>>(left, right);
+		case BinaryOp::Ne: return arena.make<OpExpr<BinaryOp::Ne>>(left, right);
+		case BinaryOp::Lt: return arena.make<OpExpr<BinaryOp::Lt>>(left, right);
+		case BinaryOp::Le: return arena.make<OpExpr<BinaryOp::Le>>(left, right);
+		case BinaryOp::Gt: return arena.make<OpExpr<BinaryOp::Gt>>(left, right);
+		case BinaryOp::Ge: return arena.make<OpExpr<BinaryOp::Ge>>(left, right);
+		case BinaryOp::And: return arena.make<OpExpr<BinaryOp::And>>(left, right);
+		case BinaryOp::Or: return arena.make<OpExpr<BinaryOp::Or>>(left, right);
 	}
-	if (typeName == "auto") {
-		if (isNumber(value)) {
-			if (value.find('.') != std::string::npos) types[varName] = "float"; else types[varName] = "int";
-		} else {
-			types[varName] = "str";
+	return nullptr;
+}
+
+UnaryExpr* makeUnary(Arena& arena, UnaryOp op, Expr* operand) {
+	if (op == UnaryOp::Not) return arena.make<NotExpr>(operand);
+	return arena.make<NegExpr>(operand);
+}
+
+static bool reads(const Expr& e, int slot) {
+	switch (e.kind) {
+		case ExprKind::Literal: return false;
+		case ExprKind::Identifier: return static_cast<const IdentifierExpr&>(e).slot == slot;
+		case ExprKind::Unary: return reads(*static_cast<const UnaryExpr&>(e).expr, slot);
+		case ExprKind::Binary: {
+			auto& bin = static_cast<const BinaryExpr&>(e);
+			return reads(*bin.left, slot) || reads(*bin.right, slot);
 		}
-	} else {
-		types[varName] = typeName;
 	}
-	vars[varName] = value;
-	return true;
+	return false;
 }
 
-bool PrintStmt::execute(VarTable& vars, TypeTable& /*types*/) {
-	std::string out = content;
-	size_t pos = 0;
-	while ((pos = out.find('{', pos)) != std::string::npos) {
-		size_t end = out.find('}', pos);
-		if (end == std::string::npos) break;
-		std::string var = out.substr(pos+1, end-pos-1);
-		auto it = vars.find(var);
-		std::string val = (it != vars.end()) ? it->second : std::string("undefined");
-		out.replace(pos, end-pos+1, val);
-		pos += val.size();
+// The operands of 'x + a + b ...' on the left spine, in order; 0 for
+// another shape.
+static int addChain(Expr* e, int slot, Expr* (&tails)[kMaxAppendTails]) {
+	int count = 0;
+	while (e->kind == ExprKind::Binary && static_cast<BinaryExpr*>(e)->op == BinaryOp::Add) {
+		if (count == kMaxAppendTails) return 0;
+		tails[count++] = static_cast<BinaryExpr*>(e)->right;
+		e = static_cast<BinaryExpr*>(e)->left;
 	}
-	std::cout << out << std::endl;
-	return true;
+	if (count == 0 || e->kind != ExprKind::Identifier || static_cast<IdentifierExpr*>(e)->slot != slot) return 0;
+	std::reverse(tails, tails + count);
+	return count;
 }
 
-bool ReadStmt::execute(VarTable& vars, TypeTable& types) {
-	if (!types.count(varName)) {
-		std::cout << "[error] undeclared variable: " << varName << std::endl;
-		return false;
-	}
-	std::string input;
-	std::cout << varName << ": ";
-	std::cout.flush();
-	std::getline(std::cin, input);
-	if (types[varName] == "int") {
-		try {
-			int v = std::stoi(input);
-			vars[varName] = std::to_string(v);
-		} catch (...) {
-			std::cout << "[error] invalid value for int" << std::endl;
-			return false;
-		}
-	} else if (types[varName] == "float") {
-		try {
-			double v = std::stod(input);
-			vars[varName] = std::to_string(v);
-		} catch (...) {
-			std::cout << "[error] invalid value for float" << std::endl;
-			return false;
-		}
-	} else {
-		vars[varName] = input;
-	}
+int appendTails(Expr* e, int slot, Expr* (&tails)[kMaxAppendTails]) {
+	int count = addChain(e, slot, tails);
+	for (int i = 0; i < count; ++i)
+		if (reads(*tails[i], slot)) return 0;
+	return count;
+}
+
+bool VarDeclStmt::execute(Frame& frame) {
+	Value value = initExpr ? initExpr->evaluate(frame) : Runtime::defaultValue(declType);
+	if (frame.fault) return false;
+	return Runtime::declare(frame, slot, declType, std::move(value));
+}
+
+bool PrintStmt::execute(Frame& frame) {
+	Runtime::print(frame, parts);
 	return true;
 }
 
-bool AssignStmt::execute(VarTable& vars, TypeTable& types) {
-	if (!types.count(varName)) {
-		std::cout << "[error] assignment to undeclared variable: " << varName << std::endl;
-		return false;
+bool ReadStmt::execute(Frame& frame) {
+	return Runtime::read(frame, slot);
+}
+
+bool AssignStmt::execute(Frame& frame) {
+	if (appendsInPlace) {
+		// Every operand is evaluated before the text changes, as with '+'.
+		Expr* tails[kMaxAppendTails];
+		Value values[kMaxAppendTails];
+		int count = addChain(expr, slot, tails);
+		for (int i = 0; i < count; ++i) values[i] = tails[i]->evaluate(frame);
+		if (frame.fault) return false;
+		if (count > 0) return Runtime::append(frame, slot, values, count);
 	}
-	std::string v = expr->evaluate(vars, types);
-	if (types[varName] == "int") {
-		if (!isAllDigits(v)) {
-			std::cout << "[fatal] type mismatch: cannot assign string to int" << std::endl;
-			return false;
-		}
-	} else if (types[varName] == "float") {
-		if (!isNumber(v)) {
-			std::cout << "[fatal] type mismatch: cannot assign non-number to float" << std::endl;
-			return false;
-		}
+	Value value = expr->evaluate(frame);
+	if (frame.fault) return false;
+	return Runtime::assign(frame, slot, std::move(value));
+}
+
+bool BlockStmt::execute(Frame& frame) {
+	for (Stmt* st : statements) {
+		if (st->line > 0) Err::setCurrentLine(st->line);
+		bool ok = frame.profiler && st->site >= 0 ? frame.profiler->execute(*st, frame) : st->execute(frame);
+		if (!ok) return false;
 	}
-	vars[varName] = v;
 	return true;
 }
 
-bool BlockStmt::execute(VarTable& vars, TypeTable& types) {
-	for (auto& st : statements) {
-		if (!st->execute(vars, types)) return false;
-	}
+bool IfStmt::execute(Frame& frame) {
+	bool taken = condition->evaluate(frame).truthy();
+	if (frame.fault) return false;
+	if (taken) return thenBlock->execute(frame);
+	if (elseBlock) return elseBlock->execute(frame);
 	return true;
 }
 
+bool WhileStmt::execute(Frame& frame) {
+	while (true) {
+		bool again = condition->evaluate(frame).truthy();
+		if (frame.fault) return false;
+		if (frame.profiler && site >= 0) frame.profiler->countEval(site);
+		if (!again) return true;
+		if (!body->execute(frame)) return false;
+		if (step) {
+			Err::setCurrentLine(step->line);
+			bool ok = frame.profiler && step->site >= 0 ? frame.profiler->execute(*step, frame) : step->execute(frame);
+			if (!ok) return false;
+		}
+	}
+}
 
 
@@ -0,0 +1,179 @@
+#include "Batch.h"
+#include "Error.h"
+#include "Input.h"
+#include "Interpreter.h"
+#include "Output.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// What one record printed; filled by a worker, emitted by the main thread.
+struct Result {
+	std::string out;
+	std::string err;
+	std::atomic<bool> done{false};
+};
+
+// Records [begin, end) left to one worker. The owner takes from the front,
+// thieves take the back half.
+struct Slice {
+	std::mutex mutex;
+	size_t begin = 0;
+	size_t end = 0;
+};
+
+struct State {
+	const Interpreter& interp;
+	std::vector<std::string_view> records;
+	std::vector<Result> results;
+	std::vector<Slice> slices;
+	std::atomic<bool> timeExec{false};
+	// Record the main thread is blocked on; the worker finishing it wakes it.
+	std::atomic<size_t> awaited{SIZE_MAX};
+	std::mutex readyMutex;
+	std::condition_variable ready;
+	explicit State(const Interpreter& i) : interp(i) {}
+};
+
+bool takeFront(Slice& slice, size_t& record) {
+	std::lock_guard<std::mutex> lock(slice.mutex);
+	if (slice.begin == slice.end) return false;
+	record = slice.begin++;
+	return true;
+}
+
+// Moves the back half of the fullest other slice into slice self; false
+// once every slice looks empty.
+bool steal(State& s, size_t self) {
+	while (true) {
+		size_t victim = self, most = 0;
+		for (size_t w = 0; w < s.slices.size(); ++w) {
+			if (w == self) continue;
+			std::lock_guard<std::mutex> lock(s.slices[w].mutex);
+			size_t left = s.slices[w].end - s.slices[w].begin;
+			if (left > most) { most = left; victim = w; }
+		}
+		if (most == 0) return false;
+		size_t begin, end;
+		{
+			Slice& v = s.slices[victim];
+			std::lock_guard<std::mutex> lock(v.mutex);
+			size_t left = v.end - v.begin;
+			if (left == 0) continue; // emptied meanwhile; look again
+			end = v.end;
+			begin = end - (left + 1) / 2;
+			v.end = begin;
+		}
+		Slice& mine = s.slices[self];
+		std::lock_guard<std::mutex> lock(mine.mutex);
+		mine.begin = begin;
+		mine.end = end;
+		return true;
+	}
+}
+
+bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// One read() per whitespace-separated field of the record.
+void fieldsToLines(std::string_view record, std::string& lines) {
+	lines.clear();
+	size_t i = 0;
+	while (true) {
+		while (i < record.size() && isBlank(record[i])) i++;
+		if (i == record.size()) break;
+		size_t start = i;
+		while (i < record.size() && !isBlank(record[i])) i++;
+		lines.append(record.data() + start, i - start);
+		lines += '\n';
+	}
+}
+
+void work(State& s, size_t self) {
+	Frame frame;
+	VM vm;
+	s.interp.initFrame(frame);
+	std::string lines;
+	std::ostringstream err;
+	Err::beginThread(err);
+	size_t i;
+	while (takeFront(s.slices[self], i) || (steal(s, self) && takeFront(s.slices[self], i))) {
+		Result& result = s.results[i];
+		fieldsToLines(s.records[i], lines);
+		In::beginThread(lines);
+		Out::beginThread(result.out);
+		frame.reset();
+		Err::setCurrentLine(0);
+		s.interp.runIn(frame, vm);
+		Out::endThread();
+		In::endThread();
+		if (frame.timeExec) s.timeExec.store(true, std::memory_order_relaxed);
+		result.err = err.str();
+		err.str("");
+		result.done.store(true);
+		if (s.awaited.load() == i) {
+			std::lock_guard<std::mutex> lock(s.readyMutex);
+			s.ready.notify_one();
+		}
+	}
+	Err::endThread();
+}
+
+} // namespace
+
+bool Batch::run(const Interpreter& interp, std::string_view input, unsigned jobs) {
+	State s(interp);
+	while (!input.empty()) {
+		size_t nl = input.find('\n');
+		s.records.push_back(input.substr(0, nl));
+		input.remove_prefix(nl == std::string_view::npos ? input.size() : nl + 1);
+	}
+	size_t n = s.records.size();
+	if (n == 0) return false;
+	if (jobs == 0) jobs = 1;
+	if (jobs > n) jobs = static_cast<unsigned>(n);
+	s.results = std::vector<Result>(n);
+	s.slices = std::vector<Slice>(jobs);
+	for (size_t w = 0; w < jobs; ++w) {
+		s.slices[w].begin = n * w / jobs;
+		s.slices[w].end = n * (w + 1) / jobs;
+	}
+	std::vector<std::thread> workers;
+	for (size_t w = 0; w < jobs; ++w) workers.emplace_back(work, std::ref(s), w);
+
+	// Emit in input order while the workers run. A record that is not done
+	// yet is waited for together with the next ones, so the main thread
+	// wakes once per kWakeBatch records rather than once per record. Slices
+	// run in parallel, so the last record of the batch can finish before
+	// the first: then the wait falls back to the record itself.
+	constexpr size_t kWakeBatch = 64;
+	size_t target = 0;
+	for (size_t i = 0; i < n; ++i) {
+		Result& result = s.results[i];
+		if (target <= i) target = std::min(i + kWakeBatch, n) - 1;
+		while (!result.done.load()) {
+			if (s.results[target].done.load()) target = i;
+			std::unique_lock<std::mutex> lock(s.readyMutex);
+			s.awaited.store(target);
+			s.ready.wait(lock, [&] { return s.results[target].done.load(); });
+		}
+		Out::write(result.out);
+		if (!result.err.empty()) {
+			// stdout is buffered: drain the earlier records first so a merged
+			// stream keeps the input order
+			Out::flush();
+			std::cerr << result.err;
+		}
+		std::string().swap(result.out);
+		std::string().swap(result.err);
+	}
+	for (auto& worker : workers) worker.join();
+	return s.timeExec.load();
+}
@@ -0,0 +1,196 @@
+#include "Compiler.h"
+#include "Runtime.h"
+
+const char* opCodeName(OpCode op) {
+	switch (op) {
+		case OpCode::Const: return "CONST";
+		case OpCode::Load: return "LOAD";
+		case OpCode::Add: return "ADD";
+		case OpCode::Sub: return "SUB";
+		case OpCode::Mul: return "MUL";
+		case OpCode::Div: return "DIV";
+		case OpCode::Mod: return "MOD";
+		case OpCode::Neg: return "NEG";
+		case OpCode::Eq: return "EQ";
+		case OpCode::Ne: return "NE";
+		case OpCode::Lt: return "LT";
+		case OpCode::Le: return "LE";
+		case OpCode::Gt: return "GT";
+		case OpCode::Ge: return "GE";
+		case OpCode::Not: return "NOT";
+		case OpCode::ToBool: return "TO_BOOL";
+		case OpCode::Jump: return "JUMP";
+		case OpCode::JumpIfFalse: return "JUMP_IF_FALSE";
+		case OpCode::AndJump: return "AND_JUMP";
+		case OpCode::OrJump: return "OR_JUMP";
+		case OpCode::Decl: return "DECL";
+		case OpCode::Store: return "STORE";
+		case OpCode::Append: return "APPEND";
+		case OpCode::Print: return "PRINT";
+		case OpCode::Read: return "READ";
+		case OpCode::TimeExec: return "TIMEEXEC";
+		case OpCode::ProfEnter: return "PROF_ENTER";
+		case OpCode::ProfLeave: return "PROF_LEAVE";
+		case OpCode::ProfEval: return "PROF_EVAL";
+		case OpCode::Halt: return "HALT";
+	}
+	return "?";
+}
+
+// Opcode of a non-logical operator (&& and || compile to jumps).
+static OpCode binaryOpCode(BinaryOp op) {
+	switch (op) {
+		case BinaryOp::Add: return OpCode::Add;
+		case BinaryOp::Sub: return OpCode::Sub;
+		case BinaryOp::Mul: return OpCode::Mul;
+		case BinaryOp::Div: return OpCode::Div;
+		case BinaryOp::Mod: return OpCode::Mod;
+		case BinaryOp::Eq: return OpCode::Eq;
+		case BinaryOp::Ne: return OpCode::Ne;
+		case BinaryOp::Lt: return OpCode::Lt;
+		case BinaryOp::Le: return OpCode::Le;
+		case BinaryOp::Gt: return OpCode::Gt;
+		default: return OpCode::Ge;
+	}
+}
+
+size_t Compiler::emit(OpCode op, int32_t arg, uint8_t aux) {
+	chunk.code.push_back({op, aux, arg});
+	chunk.lines.push_back(line);
+	return chunk.code.size() - 1;
+}
+
+int32_t Compiler::addConstant(const Value& v) {
+	chunk.constants.push_back(v);
+	return static_cast<int32_t>(chunk.constants.size() - 1);
+}
+
+void Compiler::compileExpr(const Expr& e) {
+	switch (e.kind) {
+		case ExprKind::Literal:
+			emit(OpCode::Const, addConstant(static_cast<const LiteralExpr&>(e).value));
+			push();
+			break;
+		case ExprKind::Identifier:
+			emit(OpCode::Load, static_cast<const IdentifierExpr&>(e).slot);
+			push();
+			break;
+		case ExprKind::Binary: {
+			auto& bin = static_cast<const BinaryExpr&>(e);
+			compileExpr(*bin.left);
+			if (isLogical(bin.op)) {
+				// The left operand stays on the stack as the result when it
+				// decides; otherwise it is popped and the right one decides.
+				size_t skip = emit(bin.op == BinaryOp::And ? OpCode::AndJump : OpCode::OrJump);
+				pop();
+				compileExpr(*bin.right);
+				emit(OpCode::ToBool);
+				patchJump(skip);
+				break;
+			}
+			compileExpr(*bin.right);
+			emit(binaryOpCode(bin.op));
+			pop();
+			break;
+		}
+		case ExprKind::Unary: {
+			auto& un = static_cast<const UnaryExpr&>(e);
+			compileExpr(*un.expr);
+			emit(un.op == UnaryOp::Not ? OpCode::Not : OpCode::Neg);
+			break;
+		}
+	}
+}
+
+void Compiler::compileStmt(const Stmt& st) {
+	if (st.line > 0) line = st.line;
+	// Profiler sites exist only under --profile; other programs get no hooks.
+	if (st.site >= 0) {
+		emit(OpCode::ProfEnter, st.site);
+		compileStmtBody(st);
+		line = st.line;
+		emit(OpCode::ProfLeave, st.site);
+		return;
+	}
+	compileStmtBody(st);
+}
+
+void Compiler::compileStmtBody(const Stmt& st) {
+	switch (st.kind) {
+		case StmtKind::VarDecl: {
+			auto& decl = static_cast<const VarDeclStmt&>(st);
+			if (decl.initExpr) compileExpr(*decl.initExpr);
+			else { emit(OpCode::Const, addConstant(Runtime::defaultValue(decl.declType))); push(); }
+			emit(OpCode::Decl, decl.slot, static_cast<uint8_t>(decl.declType));
+			pop();
+			break;
+		}
+		case StmtKind::Assign: {
+			auto& as = static_cast<const AssignStmt&>(st);
+			Expr* tails[kMaxAppendTails];
+			int count = as.appendsInPlace ? appendTails(as.expr, as.slot, tails) : 0;
+			if (count > 0) {
+				for (int i = 0; i < count; ++i) compileExpr(*tails[i]);
+				emit(OpCode::Append, as.slot, static_cast<uint8_t>(count));
+				pop(count);
+				break;
+			}
+			compileExpr(*as.expr);
+			emit(OpCode::Store, as.slot);
+			pop();
+			break;
+		}
+		case StmtKind::Print:
+			chunk.prints.push_back(static_cast<const PrintStmt&>(st).parts);
+			emit(OpCode::Print, static_cast<int32_t>(chunk.prints.size() - 1));
+			break;
+		case StmtKind::Read:
+			emit(OpCode::Read, static_cast<const ReadStmt&>(st).slot);
+			break;
+		case StmtKind::Block:
+			for (auto& child : static_cast<const BlockStmt&>(st).statements) compileStmt(*child);
+			break;
+		case StmtKind::If: {
+			auto& ifs = static_cast<const IfStmt&>(st);
+			compileExpr(*ifs.condition);
+			size_t toElse = emit(OpCode::JumpIfFalse);
+			pop();
+			compileStmt(*ifs.thenBlock);
+			if (ifs.elseBlock) {
+				size_t toEnd = emit(OpCode::Jump);
+				patchJump(toElse);
+				compileStmt(*ifs.elseBlock);
+				patchJump(toEnd);
+			} else {
+				patchJump(toElse);
+			}
+			break;
+		}
+		case StmtKind::While: {
+			auto& loop = static_cast<const WhileStmt&>(st);
+			int32_t top = static_cast<int32_t>(chunk.code.size());
+			compileExpr(*loop.condition);
+			if (st.site >= 0) emit(OpCode::ProfEval, st.site);
+			size_t toEnd = emit(OpCode::JumpIfFalse);
+			pop();
+			compileStmt(*loop.body);
+			if (loop.step) compileStmt(*loop.step);
+			line = st.line;
+			emit(OpCode::Jump, top);
+			patchJump(toEnd);
+			break;
+		}
+		case StmtKind::TimeExec:
+			emit(OpCode::TimeExec);
+			break;
+	}
+}
+
+Chunk Compiler::compile(const BlockStmt& program) {
+	chunk = Chunk();
+	depth = 0;
+	line = 0;
+	compileStmt(program);
+	emit(OpCode::Halt);
+	return std::move(chunk);
+}
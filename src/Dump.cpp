@@ -0,0 +1,112 @@
+#include "Dump.h"
+#include <string>
+
+static void indent(std::ostream& os, int depth) {
+	for (int i = 0; i < depth; ++i) os << "  ";
+}
+
+static void dumpExpr(const Expr& e, std::ostream& os, int depth) {
+	indent(os, depth);
+	switch (e.kind) {
+		case ExprKind::Literal: {
+			const Value& v = static_cast<const LiteralExpr&>(e).value;
+			switch (v.kind()) {
+				case ValueKind::Int: os << "int " << v.toString() << "\n"; break;
+				case ValueKind::Float: os << "float " << v.toString() << "\n"; break;
+				case ValueKind::Bool: os << "bool " << v.toString() << "\n"; break;
+				case ValueKind::Str: os << "str \"" << v.asStr() << "\"\n"; break;
+			}
+			break;
+		}
+		case ExprKind::Identifier: {
+			auto& id = static_cast<const IdentifierExpr&>(e);
+			os << "var " << id.name << " #" << id.slot << "\n";
+			break;
+		}
+		case ExprKind::Binary: {
+			auto& bin = static_cast<const BinaryExpr&>(e);
+			os << "binary " << opSymbol(bin.op) << "\n";
+			dumpExpr(*bin.left, os, depth + 1);
+			dumpExpr(*bin.right, os, depth + 1);
+			break;
+		}
+		case ExprKind::Unary: {
+			auto& un = static_cast<const UnaryExpr&>(e);
+			os << "unary " << opSymbol(un.op) << "\n";
+			dumpExpr(*un.expr, os, depth + 1);
+			break;
+		}
+	}
+}
+
+static void dumpStmt(const Stmt& st, std::ostream& os, int depth) {
+	indent(os, depth);
+	switch (st.kind) {
+		case StmtKind::VarDecl: {
+			auto& decl = static_cast<const VarDeclStmt&>(st);
+			os << "decl " << decl.typeName << " " << decl.varName << " #" << decl.slot << "  (line " << st.line << ")\n";
+			if (decl.initExpr) dumpExpr(*decl.initExpr, os, depth + 1);
+			break;
+		}
+		case StmtKind::Assign: {
+			auto& as = static_cast<const AssignStmt&>(st);
+			os << "assign " << as.varName << " #" << as.slot << "  (line " << st.line << ")\n";
+			dumpExpr(*as.expr, os, depth + 1);
+			break;
+		}
+		case StmtKind::Print: {
+			std::string text;
+			for (const auto& part : static_cast<const PrintStmt&>(st).parts) {
+				if (part.variable) {
+					text += "{" + std::string(part.text) + " #" + std::to_string(part.slot) + "}";
+					continue;
+				}
+				for (char c : part.text) {
+					if (c == '\n') text += "\\n"; else text += c;
+				}
+			}
+			os << "print \"" << text << "\"  (line " << st.line << ")\n";
+			break;
+		}
+		case StmtKind::Read: {
+			auto& rd = static_cast<const ReadStmt&>(st);
+			os << "read " << rd.varName << " #" << rd.slot << "  (line " << st.line << ")\n";
+			break;
+		}
+		case StmtKind::Block:
+			os << "block\n";
+			for (auto& child : static_cast<const BlockStmt&>(st).statements) dumpStmt(*child, os, depth + 1);
+			break;
+		case StmtKind::If: {
+			auto& ifs = static_cast<const IfStmt&>(st);
+			os << "if  (line " << st.line << ")\n";
+			dumpExpr(*ifs.condition, os, depth + 1);
+			dumpStmt(*ifs.thenBlock, os, depth + 1);
+			if (ifs.elseBlock) {
+				indent(os, depth);
+				os << "else\n";
+				dumpStmt(*ifs.elseBlock, os, depth + 1);
+			}
+			break;
+		}
+		case StmtKind::While: {
+			auto& loop = static_cast<const WhileStmt&>(st);
+			os << "while  (line " << st.line << ")\n";
+			dumpExpr(*loop.condition, os, depth + 1);
+			dumpStmt(*loop.body, os, depth + 1);
+			if (loop.step) {
+				indent(os, depth);
+				os << "step\n";
+				dumpStmt(*loop.step, os, depth + 1);
+			}
+			break;
+		}
+		case StmtKind::TimeExec:
+			os << "timeexec  (line " << st.line << ")\n";
+			break;
+	}
+}
+
+void dumpProgram(const BlockStmt& program, std::ostream& os) {
+	dumpStmt(program, os, 0);
+}
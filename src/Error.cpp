@@ -1,16 +1,22 @@
 #include "Error.h"
 #include <iostream>
 
-static int g_currentLine = 0;
+// Per thread, so --batch workers report their own lines.
+static thread_local int g_currentLine = 0;
+static thread_local int g_lineOffset = 0;
+static thread_local std::ostream* g_stream = nullptr;
 
 void Err::setCurrentLine(int line) { g_currentLine = line; }
-int Err::getCurrentLine() { return g_currentLine; }
+int Err::getCurrentLine() { return g_currentLine > 0 ? g_currentLine + g_lineOffset : 0; }
+void Err::setLineOffset(int offset) { g_lineOffset = offset; }
+
+std::ostream& Err::stream() { return g_stream ? *g_stream : std::cerr; }
+void Err::beginThread(std::ostream& out) { g_stream = &out; }
+void Err::endThread() { g_stream = nullptr; }
 
 void Err::print(const std::string& tag, const std::string& msg) {
 	if (g_currentLine > 0)
-		std::cout << "[" << tag << "] line " << g_currentLine << ": " << msg << std::endl;
+		stream() << "[" << tag << "] line " << g_currentLine + g_lineOffset << ": " << msg << '\n';
 	else
-		std::cout << "[" << tag << "] " << msg << std::endl;
+		stream() << "[" << tag << "] " << msg << '\n';
 }
-
-
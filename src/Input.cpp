@@ -0,0 +1,60 @@
+#include "Input.h"
+#include "SourceBuffer.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+struct BulkInput {
+	SourceBuffer buffer;
+	std::string_view rest;
+	bool enabled = false;
+};
+
+thread_local BulkInput threadInput; // beginThread()
+thread_local const In::Provider* threadProvider = nullptr;
+
+BulkInput& bulk() {
+	static BulkInput b;
+	return threadInput.enabled ? threadInput : b;
+}
+
+} // namespace
+
+bool In::openBulk(const std::string& path, std::string& errorMsg) {
+	BulkInput& in = bulk();
+	if (!in.buffer.open(path, errorMsg)) return false;
+	in.rest = in.buffer.view();
+	in.enabled = true;
+	return true;
+}
+
+bool In::isBulk() { return threadProvider || bulk().enabled; }
+
+void In::beginThread(std::string_view text) {
+	threadInput.rest = text;
+	threadInput.enabled = true;
+}
+
+void In::beginThread(const Provider& provider) { threadProvider = &provider; }
+
+void In::endThread() {
+	threadInput.rest = {};
+	threadInput.enabled = false;
+	threadProvider = nullptr;
+}
+
+std::string_view In::readLine() {
+	if (threadProvider) return (*threadProvider)();
+	BulkInput& in = bulk();
+	if (!in.enabled) {
+		static thread_local std::string line;
+		std::getline(std::cin, line);
+		return line;
+	}
+	const char* nl = static_cast<const char*>(std::memchr(in.rest.data(), '\n', in.rest.size()));
+	size_t len = nl ? static_cast<size_t>(nl - in.rest.data()) : in.rest.size();
+	std::string_view line = in.rest.substr(0, len);
+	in.rest.remove_prefix(nl ? len + 1 : len);
+	return line;
+}
@@ -0,0 +1,400 @@
+#include "Jit.h"
+#include "Error.h"
+#include "TypeChecker.h"
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define JIT_X86_64 0
+#endif
+
+namespace {
+
+std::atomic<uint64_t> compiledCount{0};
+std::atomic<uint64_t> checkedCount{0};
+std::atomic<uint64_t> mismatchCount{0};
+
+#if JIT_X86_64
+
+using TypeMap = std::unordered_map<const Expr*, StaticType>;
+
+// Evaluations before a root is compiled under Mode::On.
+constexpr uint32_t kHotThreshold = 1000;
+
+// A root flattened in postorder: children come before their parent and the
+// root is last.
+struct IrNode {
+	enum class Kind : uint8_t { Const, Load, Neg, Not, Binary };
+	Kind kind = Kind::Const;
+	BinaryOp op = BinaryOp::Add;
+	StaticType type = StaticType::Int; // Int, Float or Bool
+	int left = -1;
+	int right = -1;
+	int64_t bits = 0; // Const: the int, or the bits of the double; Load: the slot
+};
+
+bool isNumber(StaticType t) { return t == StaticType::Int || t == StaticType::Float || t == StaticType::Bool; }
+
+// Index of e's node in ir, or -1 when the subtree cannot run natively.
+int flatten(const Expr* e, const TypeMap& types, std::vector<IrNode>& ir) {
+	auto it = types.find(e);
+	if (it == types.end() || !isNumber(it->second)) return -1;
+	IrNode node;
+	node.type = it->second;
+	switch (e->kind) {
+		case ExprKind::Literal: {
+			const Value& v = static_cast<const LiteralExpr*>(e)->value;
+			if (v.isStr()) return -1;
+			node.kind = IrNode::Kind::Const;
+			if (v.kind() == ValueKind::Float) {
+				double d = v.asFloat();
+				std::memcpy(&node.bits, &d, sizeof d);
+			} else {
+				node.bits = v.asInt();
+			}
+			break;
+		}
+		case ExprKind::Identifier:
+			if (node.type == StaticType::Bool) return -1; // variables hold ints, not bools
+			node.kind = IrNode::Kind::Load;
+			node.bits = static_cast<const IdentifierExpr*>(e)->slot;
+			break;
+		case ExprKind::Unary: {
+			auto* un = static_cast<const UnaryExpr*>(e);
+			node.kind = un->op == UnaryOp::Not ? IrNode::Kind::Not : IrNode::Kind::Neg;
+			if ((node.left = flatten(un->expr, types, ir)) < 0) return -1;
+			break;
+		}
+		case ExprKind::Binary: {
+			auto* bin = static_cast<const BinaryExpr*>(e);
+			if (bin->op == BinaryOp::Mod && node.type == StaticType::Float) return -1; // fmod
+			node.kind = IrNode::Kind::Binary;
+			node.op = bin->op;
+			if ((node.left = flatten(bin->left, types, ir)) < 0) return -1;
+			if ((node.right = flatten(bin->right, types, ir)) < 0) return -1;
+			break;
+		}
+	}
+	ir.push_back(node);
+	return static_cast<int>(ir.size() - 1);
+}
+
+// Signature of generated code: false asks the caller to evaluate the tree
+// instead (int division by 0 or -1).
+using NativeFn = bool (*)(const Value* slots, int64_t* result);
+
+// Emits x86-64 for an IR root. Ints and bools live in rax, floats in xmm0;
+// the left operand of a binary node waits on the machine stack while the
+// right one is computed, then moves to rax/xmm0 with the right in rcx/xmm1.
+class CodeGen {
+public:
+	explicit CodeGen(const std::vector<IrNode>& ir) : ir(ir) {}
+
+	std::vector<uint8_t> run() {
+		emit({0x53});             // push rbx
+		emit({0x48, 0x89, 0xE3}); // mov rbx, rsp (restored on every exit)
+		int root = static_cast<int>(ir.size() - 1);
+		gen(root);
+		if (ir[root].type == StaticType::Float) emit({0xF2, 0x0F, 0x11, 0x06}); // movsd [rsi], xmm0
+		else emit({0x48, 0x89, 0x06});                                          // mov [rsi], rax
+		emit({0xB8, 0x01, 0x00, 0x00, 0x00}); // mov eax, 1
+		emitReturn();
+		for (size_t at : bailouts) bind(at);
+		emit({0x31, 0xC0}); // xor eax, eax
+		emitReturn();
+		return std::move(code);
+	}
+
+private:
+	void emit(std::initializer_list<uint8_t> bytes) { code.insert(code.end(), bytes); }
+	void emitReturn() { emit({0x48, 0x89, 0xDC, 0x5B, 0xC3}); } // mov rsp, rbx; pop rbx; ret
+	void imm32(int32_t v) { const auto* p = reinterpret_cast<const uint8_t*>(&v); code.insert(code.end(), p, p + 4); }
+	void imm64(int64_t v) { const auto* p = reinterpret_cast<const uint8_t*>(&v); code.insert(code.end(), p, p + 8); }
+	// Jump with a rel32 operand to fill in with bind().
+	size_t jump(std::initializer_list<uint8_t> opcode) { emit(opcode); imm32(0); return code.size() - 4; }
+	void bind(size_t at) {
+		int32_t rel = static_cast<int32_t>(code.size() - (at + 4));
+		std::memcpy(&code[at], &rel, sizeof rel);
+	}
+	void setFlagToRax(uint8_t setcc) { emit({0x0F, setcc, 0xC0, 0x0F, 0xB6, 0xC0}); } // setcc al; movzx eax, al
+
+	bool isFloat(int n) const { return ir[n].type == StaticType::Float; }
+
+	void genAs(int n, bool asFloat) {
+		gen(n);
+		if (asFloat && !isFloat(n)) emit({0xF2, 0x48, 0x0F, 0x2A, 0xC0}); // cvtsi2sd xmm0, rax
+	}
+
+	// 0 or 1 in rax, as Value::truthy().
+	void genTruthy(int n) {
+		gen(n);
+		if (isFloat(n)) {
+			emit({0x66, 0x0F, 0x57, 0xC9}); // xorpd xmm1, xmm1
+			emit({0x66, 0x0F, 0x2E, 0xC1}); // ucomisd xmm0, xmm1
+			emit({0x0F, 0x95, 0xC0});       // setne al
+			emit({0x0F, 0x9A, 0xC1});       // setp cl (NaN is truthy)
+			emit({0x08, 0xC8});             // or al, cl
+			emit({0x0F, 0xB6, 0xC0});       // movzx eax, al
+		} else {
+			emit({0x48, 0x85, 0xC0}); // test rax, rax
+			setFlagToRax(0x95);       // setne
+		}
+	}
+
+	void gen(int n) {
+		const IrNode& node = ir[n];
+		switch (node.kind) {
+			case IrNode::Kind::Const:
+				emit({0x48, 0xB8}); // mov rax, imm64
+				imm64(node.bits);
+				if (isFloat(n)) emit({0x66, 0x48, 0x0F, 0x6E, 0xC0}); // movq xmm0, rax
+				break;
+			case IrNode::Kind::Load: {
+				int64_t disp = node.bits * static_cast<int64_t>(sizeof(Value)) + static_cast<int64_t>(Value::payloadOffset());
+				if (isFloat(n)) emit({0xF2, 0x0F, 0x10, 0x87}); // movsd xmm0, [rdi + disp32]
+				else emit({0x48, 0x8B, 0x87});                  // mov rax, [rdi + disp32]
+				imm32(static_cast<int32_t>(disp));
+				break;
+			}
+			case IrNode::Kind::Not:
+				genTruthy(node.left);
+				emit({0x48, 0x83, 0xF0, 0x01}); // xor rax, 1
+				break;
+			case IrNode::Kind::Neg:
+				gen(node.left);
+				if (isFloat(n)) {
+					emit({0x48, 0xB8}); // mov rax, sign bit
+					imm64(INT64_MIN);
+					emit({0x66, 0x48, 0x0F, 0x6E, 0xC8}); // movq xmm1, rax
+					emit({0x66, 0x0F, 0x57, 0xC1});       // xorpd xmm0, xmm1
+				} else {
+					emit({0x48, 0xF7, 0xD8}); // neg rax
+				}
+				break;
+			case IrNode::Kind::Binary:
+				genBinary(node);
+				break;
+		}
+	}
+
+	void genBinary(const IrNode& node) {
+		if (isLogical(node.op)) {
+			// Short-circuit: rax already holds the result when the left side decides.
+			genTruthy(node.left);
+			emit({0x48, 0x85, 0xC0}); // test rax, rax
+			size_t done = node.op == BinaryOp::And ? jump({0x0F, 0x84}) : jump({0x0F, 0x85}); // jz / jnz
+			genTruthy(node.right);
+			bind(done);
+			return;
+		}
+		bool f = isFloat(node.left) || isFloat(node.right);
+		genAs(node.left, f);
+		if (f) emit({0x48, 0x83, 0xEC, 0x08, 0xF2, 0x0F, 0x11, 0x04, 0x24}); // sub rsp, 8; movsd [rsp], xmm0
+		else emit({0x50});                                                    // push rax
+		genAs(node.right, f);
+		if (f) {
+			emit({0x66, 0x0F, 0x28, 0xC8});                                  // movapd xmm1, xmm0
+			emit({0xF2, 0x0F, 0x10, 0x04, 0x24, 0x48, 0x83, 0xC4, 0x08}); // movsd xmm0, [rsp]; add rsp, 8
+			genFloatOp(node.op);
+		} else {
+			emit({0x48, 0x89, 0xC1, 0x58}); // mov rcx, rax; pop rax
+			genIntOp(node.op);
+		}
+	}
+
+	void genIntOp(BinaryOp op) {
+		switch (op) {
+			case BinaryOp::Add: emit({0x48, 0x01, 0xC8}); break;       // add rax, rcx (wraps)
+			case BinaryOp::Sub: emit({0x48, 0x29, 0xC8}); break;       // sub rax, rcx
+			case BinaryOp::Mul: emit({0x48, 0x0F, 0xAF, 0xC1}); break; // imul rax, rcx
+			case BinaryOp::Div:
+			case BinaryOp::Mod:
+				emit({0x48, 0x83, 0xF9, 0x00}); // cmp rcx, 0
+				bailouts.push_back(jump({0x0F, 0x84}));
+				emit({0x48, 0x83, 0xF9, 0xFF}); // cmp rcx, -1
+				bailouts.push_back(jump({0x0F, 0x84}));
+				emit({0x48, 0x99, 0x48, 0xF7, 0xF9}); // cqo; idiv rcx
+				if (op == BinaryOp::Mod) emit({0x48, 0x89, 0xD0}); // mov rax, rdx
+				break;
+			default:
+				emit({0x48, 0x39, 0xC8}); // cmp rax, rcx
+				setFlagToRax(intSetcc(op));
+				break;
+		}
+	}
+
+	static uint8_t intSetcc(BinaryOp op) {
+		switch (op) {
+			case BinaryOp::Eq: return 0x94; // sete
+			case BinaryOp::Ne: return 0x95; // setne
+			case BinaryOp::Lt: return 0x9C; // setl
+			case BinaryOp::Le: return 0x9E; // setle
+			case BinaryOp::Gt: return 0x9F; // setg
+			default: return 0x9D;           // setge
+		}
+	}
+
+	// Unordered (NaN) compares false, except '!='.
+	void genFloatOp(BinaryOp op) {
+		switch (op) {
+			case BinaryOp::Add: emit({0xF2, 0x0F, 0x58, 0xC1}); break; // addsd xmm0, xmm1
+			case BinaryOp::Sub: emit({0xF2, 0x0F, 0x5C, 0xC1}); break; // subsd
+			case BinaryOp::Mul: emit({0xF2, 0x0F, 0x59, 0xC1}); break; // mulsd
+			case BinaryOp::Div: emit({0xF2, 0x0F, 0x5E, 0xC1}); break; // divsd
+			case BinaryOp::Gt:
+			case BinaryOp::Ge:
+				emit({0x66, 0x0F, 0x2E, 0xC1}); // ucomisd xmm0, xmm1
+				setFlagToRax(op == BinaryOp::Gt ? 0x97 : 0x93); // seta / setae
+				break;
+			case BinaryOp::Lt:
+			case BinaryOp::Le:
+				emit({0x66, 0x0F, 0x2E, 0xC8}); // ucomisd xmm1, xmm0
+				setFlagToRax(op == BinaryOp::Lt ? 0x97 : 0x93);
+				break;
+			case BinaryOp::Eq:
+				emit({0x66, 0x0F, 0x2E, 0xC1});
+				emit({0x0F, 0x94, 0xC0, 0x0F, 0x9B, 0xC1, 0x20, 0xC8}); // sete al; setnp cl; and al, cl
+				emit({0x0F, 0xB6, 0xC0});
+				break;
+			default: // Ne
+				emit({0x66, 0x0F, 0x2E, 0xC1});
+				emit({0x0F, 0x95, 0xC0, 0x0F, 0x9A, 0xC1, 0x08, 0xC8}); // setne al; setp cl; or al, cl
+				emit({0x0F, 0xB6, 0xC0});
+				break;
+		}
+	}
+
+	const std::vector<IrNode>& ir;
+	std::vector<uint8_t> code;
+	std::vector<size_t> bailouts; // rel32 operands that jump to the bail-out exit
+};
+
+Value toValue(StaticType type, int64_t bits) {
+	if (type == StaticType::Bool) return Value::fromBool(bits != 0);
+	if (type == StaticType::Int) return Value::fromInt(bits);
+	double d;
+	std::memcpy(&d, &bits, sizeof d);
+	return Value::fromFloat(d);
+}
+
+bool sameValue(const Value& a, const Value& b) {
+	if (a.kind() != b.kind()) return false;
+	if (a.kind() != ValueKind::Float) return a.asInt() == b.asInt();
+	double x = a.asFloat(), y = b.asFloat();
+	return std::memcmp(&x, &y, sizeof x) == 0 || (x != x && y != y);
+}
+
+std::mutex compileMutex;
+
+// Counter, generated code and fallback of one wrapped root. Shared by every
+// thread running the program, hence the atomics.
+class NativeCode {
+public:
+	NativeCode(Expr* interpreted, std::vector<IrNode> ir, Jit::Mode mode)
+		: interpreted(interpreted), ir(std::move(ir)), verify(mode == Jit::Mode::Verify),
+		  threshold(mode == Jit::Mode::Verify ? 1 : kHotThreshold) {}
+	~NativeCode() { if (mem) munmap(mem, size); }
+
+	Value evaluate(Frame& frame) {
+		NativeFn fn = code.load(std::memory_order_acquire);
+		if (!fn) {
+			if (failed.load(std::memory_order_relaxed) || hits.fetch_add(1, std::memory_order_relaxed) + 1 < threshold)
+				return interpreted->evaluate(frame);
+			if (!(fn = compile())) return interpreted->evaluate(frame);
+		}
+		int64_t bits;
+		if (!fn(frame.values.data(), &bits)) return interpreted->evaluate(frame);
+		Value native = toValue(ir.back().type, bits);
+		if (!verify) return native;
+		Value expected = interpreted->evaluate(frame);
+		checkedCount.fetch_add(1, std::memory_order_relaxed);
+		if (!sameValue(native, expected)) {
+			mismatchCount.fetch_add(1, std::memory_order_relaxed);
+			Err::stream() << "[jit] line " << Err::getCurrentLine() << ": native " << native.toString()
+				<< ", interpreter " << expected.toString() << '\n';
+		}
+		return expected;
+	}
+
+private:
+	NativeFn compile() {
+		std::lock_guard<std::mutex> lock(compileMutex);
+		if (NativeFn done = code.load(std::memory_order_acquire)) return done;
+		if (failed.load(std::memory_order_relaxed)) return nullptr;
+		std::vector<uint8_t> bytes = CodeGen(ir).run();
+		size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		size_t length = (bytes.size() + page - 1) / page * page;
+		// Written while writable, then switched to executable (never both).
+		void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED) { failed = true; return nullptr; }
+		std::memcpy(p, bytes.data(), bytes.size());
+		if (mprotect(p, length, PROT_READ | PROT_EXEC) != 0) {
+			munmap(p, length);
+			failed = true;
+			return nullptr;
+		}
+		mem = p;
+		size = length;
+		auto fn = reinterpret_cast<NativeFn>(p);
+		code.store(fn, std::memory_order_release);
+		compiledCount.fetch_add(1, std::memory_order_relaxed);
+		return fn;
+	}
+
+	Expr* interpreted;
+	std::vector<IrNode> ir;
+	bool verify;
+	uint32_t threshold;
+	std::atomic<uint32_t> hits{0};
+	std::atomic<NativeFn> code{nullptr};
+	std::atomic<bool> failed{false};
+	void* mem = nullptr;
+	size_t size = 0;
+};
+
+struct NativeBinaryExpr final : BinaryExpr {
+	NativeBinaryExpr(BinaryExpr& root, std::vector<IrNode> ir, Jit::Mode mode)
+		: BinaryExpr(root.op, root.left, root.right), native(&root, std::move(ir), mode) {}
+	Value evaluate(Frame& frame) override { return native.evaluate(frame); }
+	NativeCode native;
+};
+
+struct NativeUnaryExpr final : UnaryExpr {
+	NativeUnaryExpr(UnaryExpr& root, std::vector<IrNode> ir, Jit::Mode mode)
+		: UnaryExpr(root.op, root.expr), native(&root, std::move(ir), mode) {}
+	Value evaluate(Frame& frame) override { return native.evaluate(frame); }
+	NativeCode native;
+};
+
+#endif
+
+} // namespace
+
+bool Jit::available() { return JIT_X86_64 != 0; }
+
+void Jit::wrap(Expr*& root, const std::unordered_map<const Expr*, StaticType>& types, Arena& arena, Mode mode) {
+#if JIT_X86_64
+	if (mode == Mode::Off) return;
+	if (root->kind != ExprKind::Binary && root->kind != ExprKind::Unary) return; // a leaf is as cheap as a call
+	std::vector<IrNode> ir;
+	if (flatten(root, types, ir) < 0) return;
+	if (root->kind == ExprKind::Binary) root = arena.make<NativeBinaryExpr>(static_cast<BinaryExpr&>(*root), std::move(ir), mode);
+	else root = arena.make<NativeUnaryExpr>(static_cast<UnaryExpr&>(*root), std::move(ir), mode);
+#else
+	(void)root; (void)types; (void)arena; (void)mode;
+#endif
+}
+
+Jit::Stats Jit::stats() {
+	Stats s;
+	s.compiled = compiledCount.load();
+	s.checked = checkedCount.load();
+	s.mismatches = mismatchCount.load();
+	return s;
+}
@@ -1,106 +1,240 @@
 #include "Lexer.h"
-#include <cctype>
+#include <cstdint>
 
-static bool isIdentStart(char c) {
-	return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+enum CharClass : uint8_t {
+	ClsOther = 0,   // unknown byte (including every non-ASCII byte)
+	ClsBlank,       // ' ', '\t', '\r', '\v', '\f'
+	ClsNewline,
+	ClsDigit,
+	ClsIdent,       // letters and '_'
+	ClsPunct,       // single-char token, possibly the start of a two-char one
+	ClsSlash,
+	ClsQuote,
+};
+
+// 256-entry classification table built at compile time; replaces the
+// locale-aware <cctype> calls of the old per-character loop.
+struct CharTable {
+	uint8_t cls[256] = {};
+	TokenType punct[256] = {};
+	constexpr CharTable() {
+		for (int c = 0; c < 256; ++c) punct[c] = TokenType::Unknown;
+		cls[static_cast<unsigned char>(' ')] = ClsBlank;
+		cls[static_cast<unsigned char>('\t')] = ClsBlank;
+		cls[static_cast<unsigned char>('\r')] = ClsBlank;
+		cls[static_cast<unsigned char>('\v')] = ClsBlank;
+		cls[static_cast<unsigned char>('\f')] = ClsBlank;
+		cls[static_cast<unsigned char>('\n')] = ClsNewline;
+		for (int c = '0'; c <= '9'; ++c) cls[c] = ClsDigit;
+		for (int c = 'a'; c <= 'z'; ++c) cls[c] = ClsIdent;
+		for (int c = 'A'; c <= 'Z'; ++c) cls[c] = ClsIdent;
+		cls[static_cast<unsigned char>('_')] = ClsIdent;
+		cls[static_cast<unsigned char>('/')] = ClsSlash;
+		cls[static_cast<unsigned char>('"')] = ClsQuote;
+		setPunct('(', TokenType::LParen);
+		setPunct(')', TokenType::RParen);
+		setPunct('{', TokenType::LBrace);
+		setPunct('}', TokenType::RBrace);
+		setPunct('!', TokenType::Bang);
+		setPunct('<', TokenType::Less);
+		setPunct('>', TokenType::Greater);
+		setPunct('=', TokenType::Equals);
+		setPunct(';', TokenType::Semicolon);
+		setPunct(',', TokenType::Comma);
+		setPunct('+', TokenType::Plus);
+		setPunct('-', TokenType::Minus);
+		setPunct('*', TokenType::Star);
+		setPunct('%', TokenType::Percent);
+		setPunct('&', TokenType::Unknown); // only valid as "&&"
+		setPunct('|', TokenType::Unknown); // only valid as "||"
+	}
+	constexpr void setPunct(char c, TokenType type) {
+		cls[static_cast<unsigned char>(c)] = ClsPunct;
+		punct[static_cast<unsigned char>(c)] = type;
+	}
+};
+
+constexpr CharTable kChars;
+
+inline uint8_t classOf(char c) { return kChars.cls[static_cast<unsigned char>(c)]; }
+
+inline bool isIdentChar(char c) {
+	uint8_t k = classOf(c);
+	return k == ClsIdent || k == ClsDigit;
 }
 
-static bool isIdentChar(char c) {
-	return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+// Keywords are told apart by length, then first character.
+TokenType keywordOrIdentifier(std::string_view id) {
+	switch (id.size()) {
+		case 2:
+			if (id == "if") return TokenType::KeywordIf;
+			break;
+		case 3:
+			if (id[0] == 'i' && id == "int") return TokenType::KeywordInt;
+			if (id[0] == 's' && id == "str") return TokenType::KeywordStr;
+			if (id[0] == 'f' && id == "for") return TokenType::KeywordFor;
+			break;
+		case 4:
+			if (id[0] == 'r' && id == "read") return TokenType::KeywordRead;
+			if (id[0] == 'a' && id == "auto") return TokenType::KeywordAuto;
+			if (id[0] == 'e' && id == "else") return TokenType::KeywordElse;
+			break;
+		case 5:
+			if (id[0] == 'p' && id == "print") return TokenType::KeywordPrint;
+			if (id[0] == 'f' && id == "float") return TokenType::KeywordFloat;
+			if (id[0] == 'w' && id == "while") return TokenType::KeywordWhile;
+			break;
+		case 8:
+			if (id == "timeexec") return TokenType::KeywordTimeExec;
+			break;
+	}
+	return TokenType::Identifier;
 }
 
-std::vector<Token> Lexer::tokenize(const std::string& line) {
-	std::vector<Token> tokens;
-	size_t i = 0;
-	while (i < line.size()) {
-		char c = line[i];
-		if (std::isspace(static_cast<unsigned char>(c))) { i++; continue; }
+// Two-char operators: "&&", "||", "++", "--" and "==", "!=", "<=", ">=",
+// "+=", "-=", "*=", "/=", "%=".
+TokenType twoCharOperator(char a, char b) {
+	if (a == '&' && b == '&') return TokenType::AndAnd;
+	if (a == '|' && b == '|') return TokenType::OrOr;
+	if (a == '+' && b == '+') return TokenType::PlusPlus;
+	if (a == '-' && b == '-') return TokenType::MinusMinus;
+	if (b != '=') return TokenType::Unknown;
+	switch (a) {
+		case '=': return TokenType::EqualEqual;
+		case '!': return TokenType::BangEqual;
+		case '<': return TokenType::LessEqual;
+		case '>': return TokenType::GreaterEqual;
+		case '+': return TokenType::PlusEqual;
+		case '-': return TokenType::MinusEqual;
+		case '*': return TokenType::StarEqual;
+		case '/': return TokenType::SlashEqual;
+		case '%': return TokenType::PercentEqual;
+		default: return TokenType::Unknown;
+	}
+}
 
-		if (inBlockComment) {
-			// search for '*/'
-			if (c == '*' && i + 1 < line.size() && line[i+1] == '/') {
-				inBlockComment = false;
-				i += 2; continue;
-			}
-			i++; continue;
-		}
+// First position in [p, end) holding a or b, or end. Scans 16 bytes at a
+// time with SSE2 where available.
+const char* findEither(const char* p, const char* end, char a, char b) {
+#if defined(__SSE2__)
+	const __m128i va = _mm_set1_epi8(a);
+	const __m128i vb = _mm_set1_epi8(b);
+	while (end - p >= 16) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+		if (mask) return p + __builtin_ctz(static_cast<unsigned>(mask));
+		p += 16;
+	}
+#endif
+	while (p < end && *p != a && *p != b) p++;
+	return p;
+}
 
-		// line comment //
-		if (c == '/' && i + 1 < line.size() && line[i+1] == '/') {
-			break; // ignore rest of line
-		}
-		// block comment start /*
-		if (c == '/' && i + 1 < line.size() && line[i+1] == '*') {
-			inBlockComment = true;
-			i += 2; continue;
-		}
-		// two-char operators
-		if (c == '&' && i + 1 < line.size() && line[i+1] == '&') { tokens.push_back({TokenType::AndAnd, "&&"}); i += 2; continue; }
-		if (c == '|' && i + 1 < line.size() && line[i+1] == '|') { tokens.push_back({TokenType::OrOr, "||"}); i += 2; continue; }
-		if (c == '=' && i + 1 < line.size() && line[i+1] == '=') { tokens.push_back({TokenType::EqualEqual, "=="}); i += 2; continue; }
-		if (c == '!' && i + 1 < line.size() && line[i+1] == '=') { tokens.push_back({TokenType::BangEqual, "!="}); i += 2; continue; }
-		if (c == '<' && i + 1 < line.size() && line[i+1] == '=') { tokens.push_back({TokenType::LessEqual, "<="}); i += 2; continue; }
-		if (c == '>' && i + 1 < line.size() && line[i+1] == '=') { tokens.push_back({TokenType::GreaterEqual, ">="}); i += 2; continue; }
+// First position in [p, end) that is not a space or tab.
+const char* skipBlanks(const char* p, const char* end) {
+#if defined(__SSE2__)
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	while (end - p >= 16) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		int blank = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)));
+		if (blank != 0xFFFF) return p + __builtin_ctz(static_cast<unsigned>(~blank));
+		p += 16;
+	}
+#endif
+	while (p < end && (*p == ' ' || *p == '\t')) p++;
+	return p;
+}
+
+} // namespace
 
-		// single-char punctuation/operators
-		if (c == '(') { tokens.push_back({TokenType::LParen, "("}); i++; continue; }
-		if (c == ')') { tokens.push_back({TokenType::RParen, ")"}); i++; continue; }
-		if (c == '{') { tokens.push_back({TokenType::LBrace, "{"}); i++; continue; }
-		if (c == '}') { tokens.push_back({TokenType::RBrace, "}"}); i++; continue; }
-		if (c == '!') { tokens.push_back({TokenType::Bang, "!"}); i++; continue; }
-		if (c == '<') { tokens.push_back({TokenType::Less, "<"}); i++; continue; }
-		if (c == '>') { tokens.push_back({TokenType::Greater, ">"}); i++; continue; }
-		if (c == '=') { tokens.push_back({TokenType::Equals, "="}); i++; continue; }
-		if (c == ';') { tokens.push_back({TokenType::Semicolon, ";"}); i++; continue; }
-		if (c == ',') { tokens.push_back({TokenType::Comma, ","}); i++; continue; }
-		if (c == '+') { tokens.push_back({TokenType::Plus, "+"}); i++; continue; }
+std::vector<Token> Lexer::tokenize(std::string_view src, int firstLine, bool startInComment) {
+	inBlockComment = startInComment;
+	std::vector<Token> tokens;
+	tokens.reserve(src.size() / 4 + 1);
+	int line = firstLine;
+	const char* p = src.data();
+	const char* const end = p + src.size();
+	auto emit = [&](TokenType type, const char* start, size_t len) {
+		tokens.push_back({type, std::string_view(start, len), line});
+	};
 
-		if (c == '"') {
-			// string literal
-			size_t j = i + 1;
-			while (j < line.size() && line[j] != '"') j++;
-			std::string lex = (j < line.size()) ? line.substr(i+1, j-i-1) : line.substr(i+1);
-			tokens.push_back({TokenType::StrLiteral, lex});
-			i = (j < line.size()) ? j + 1 : line.size();
+	while (p < end) {
+		if (inBlockComment) {
+			// search for '*/', counting the lines it spans
+			const char* q = findEither(p, end, '*', '\n');
+			if (q == end) { p = end; break; }
+			if (*q == '\n') { line++; p = q + 1; continue; }
+			if (q + 1 < end && q[1] == '/') { inBlockComment = false; p = q + 2; continue; }
+			p = q + 1;
 			continue;
 		}
 
-		if (std::isdigit(static_cast<unsigned char>(c))) {
-			size_t j = i;
-			while (j < line.size() && std::isdigit(static_cast<unsigned char>(line[j]))) j++;
-			bool isFloat = false;
-			if (j < line.size() && line[j] == '.' && (j + 1) < line.size() && std::isdigit(static_cast<unsigned char>(line[j+1]))) {
-				isFloat = true;
-				j++; 
-				while (j < line.size() && std::isdigit(static_cast<unsigned char>(line[j]))) j++;
+		char c = *p;
+		switch (classOf(c)) {
+			case ClsBlank:
+				p = skipBlanks(p + 1, end);
+				continue;
+			case ClsNewline:
+				line++;
+				p++;
+				continue;
+			case ClsSlash:
+				if (p + 1 < end && p[1] == '/') { p = findEither(p + 2, end, '\n', '\n'); continue; } // line comment
+				if (p + 1 < end && p[1] == '*') { inBlockComment = true; p += 2; continue; }
+				if (p + 1 < end && p[1] == '=') { emit(TokenType::SlashEqual, p, 2); p += 2; continue; }
+				emit(TokenType::Slash, p, 1);
+				p++;
+				continue;
+			case ClsQuote: {
+				// string literal (an unterminated literal ends at the end of its line)
+				const char* q = findEither(p + 1, end, '"', '\n');
+				emit(TokenType::StrLiteral, p + 1, static_cast<size_t>(q - p - 1));
+				p = (q < end && *q == '"') ? q + 1 : q;
+				continue;
 			}
-			std::string num = line.substr(i, j-i);
-			tokens.push_back({isFloat ? TokenType::FloatLiteral : TokenType::IntLiteral, num});
-			i = j; continue;
-		}
-
-		if (isIdentStart(c)) {
-			size_t j = i;
-			while (j < line.size() && isIdentChar(line[j])) j++;
-			std::string id = line.substr(i, j-i);
-			if (id == "print") tokens.push_back({TokenType::KeywordPrint, id});
-			else if (id == "read") tokens.push_back({TokenType::KeywordRead, id});
-			else if (id == "int") tokens.push_back({TokenType::KeywordInt, id});
-			else if (id == "str") tokens.push_back({TokenType::KeywordStr, id});
-			else if (id == "float") tokens.push_back({TokenType::KeywordFloat, id});
-			else if (id == "auto") tokens.push_back({TokenType::KeywordAuto, id});
-			else if (id == "if") tokens.push_back({TokenType::KeywordIf, id});
-			else if (id == "else") tokens.push_back({TokenType::KeywordElse, id});
-			else if (id == "timeexec") tokens.push_back({TokenType::KeywordTimeExec, id});
-			else tokens.push_back({TokenType::Identifier, id});
-			i = j; continue;
+			case ClsDigit: {
+				const char* q = p;
+				while (q < end && classOf(*q) == ClsDigit) q++;
+				bool isFloat = false;
+				if (q + 1 < end && *q == '.' && classOf(q[1]) == ClsDigit) {
+					isFloat = true;
+					q++;
+					while (q < end && classOf(*q) == ClsDigit) q++;
+				}
+				emit(isFloat ? TokenType::FloatLiteral : TokenType::IntLiteral, p, static_cast<size_t>(q - p));
+				p = q;
+				continue;
+			}
+			case ClsIdent: {
+				const char* q = p + 1;
+				while (q < end && isIdentChar(*q)) q++;
+				std::string_view id(p, static_cast<size_t>(q - p));
+				tokens.push_back({keywordOrIdentifier(id), id, line});
+				p = q;
+				continue;
+			}
+			case ClsPunct: {
+				if (p + 1 < end) {
+					TokenType two = twoCharOperator(c, p[1]);
+					if (two != TokenType::Unknown) { emit(two, p, 2); p += 2; continue; }
+				}
+				emit(kChars.punct[static_cast<unsigned char>(c)], p, 1);
+				p++;
+				continue;
+			}
+			default:
+				emit(TokenType::Unknown, p, 1);
+				p++;
+				continue;
 		}
-
-		tokens.push_back({TokenType::Unknown, std::string(1, c)});
-		i++;
 	}
-	tokens.push_back({TokenType::EndOfInput, ""});
+	tokens.push_back({TokenType::EndOfInput, std::string_view(), line});
 	return tokens;
 }
-
-
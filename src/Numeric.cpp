@@ -0,0 +1,29 @@
+#include "Numeric.h"
+#include <cmath>
+#include <cstring>
+
+// Skips the blanks and '+' accepted before a number; "+-1" stays invalid.
+static const char* numberStart(const char* p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\v' || *p == '\f')) p++;
+	if (p < end && *p == '+' && p + 1 < end && *(p + 1) != '-') p++;
+	return p;
+}
+
+bool Numeric::parseInt(std::string_view text, int64_t& out) {
+	const char* end = text.data() + text.size();
+	return std::from_chars(numberStart(text.data(), end), end, out).ec == std::errc();
+}
+
+bool Numeric::parseFloat(std::string_view text, double& out) {
+	const char* end = text.data() + text.size();
+	return std::from_chars(numberStart(text.data(), end), end, out).ec == std::errc();
+}
+
+void Numeric::appendFloat(std::string& out, double v) {
+	char buf[40];
+	double mag = std::fabs(v);
+	bool fixed = mag == 0.0 || (mag >= 1e-4 && mag < 1e16);
+	char* last = std::to_chars(buf, buf + sizeof buf, v, fixed ? std::chars_format::fixed : std::chars_format::scientific).ptr;
+	out.append(buf, static_cast<size_t>(last - buf));
+	if (fixed && !std::memchr(buf, '.', static_cast<size_t>(last - buf))) out += ".0";
+}
@@ -0,0 +1,133 @@
+#include "Optimizer.h"
+
+static bool isLiteral(const Expr& e) { return e.kind == ExprKind::Literal; }
+
+static const Value& literalValue(const Expr& e) { return static_cast<const LiteralExpr&>(e).value; }
+
+// print() template without any {name} placeholder.
+static bool isPlainText(const PrintStmt& print) {
+	for (const auto& part : print.parts)
+		if (part.variable) return false;
+	return true;
+}
+
+// Whether evaluating e can stop the program: int '/' and '%' by zero, '+'
+// past the string size limit, and '-', '*' or unary '-' on a value whose
+// type is only known at run time.
+static bool mayFault(const Expr& e) {
+	if (e.kind == ExprKind::Unary) {
+		auto& un = static_cast<const UnaryExpr&>(e);
+		return un.op != UnaryOp::Not || mayFault(*un.expr);
+	}
+	if (e.kind != ExprKind::Binary) return false;
+	auto& bin = static_cast<const BinaryExpr&>(e);
+	return isArithmetic(bin.op) || mayFault(*bin.left) || mayFault(*bin.right);
+}
+
+void Optimizer::foldExpr(Expr*& e) {
+	if (e->kind == ExprKind::Unary) {
+		auto& un = static_cast<UnaryExpr&>(*e);
+		foldExpr(un.expr);
+		if (!isLiteral(*un.expr)) return;
+		Value negated;
+		if (un.op == UnaryOp::Not) e = arena.make<LiteralExpr>(Value::fromBool(!literalValue(*un.expr).truthy()));
+		else if (negateValue(literalValue(*un.expr), negated) == ArithError::None) e = arena.make<LiteralExpr>(std::move(negated));
+		return;
+	}
+	if (e->kind != ExprKind::Binary) return;
+	auto& bin = static_cast<BinaryExpr&>(*e);
+	foldExpr(bin.left);
+	foldExpr(bin.right);
+	bool l = isLiteral(*bin.left), r = isLiteral(*bin.right);
+	// A deciding constant on the left skips the right side, as short-circuit
+	// does. On the right it may only drop a left side that cannot fault.
+	if (isLogical(bin.op)) {
+		bool decisive = bin.op == BinaryOp::Or;
+		if ((l && literalValue(*bin.left).truthy() == decisive) ||
+		    (r && literalValue(*bin.right).truthy() == decisive && !mayFault(*bin.left))) {
+			e = arena.make<LiteralExpr>(Value::fromBool(decisive));
+			return;
+		}
+	}
+	if (!l || !r) return;
+	const Value& lv = literalValue(*bin.left);
+	const Value& rv = literalValue(*bin.right);
+	Value folded;
+	if (isArithmetic(bin.op)) {
+		// failing operations are left for the runtime to report
+		ArithError err = bin.op == BinaryOp::Add ? addValues(lv, rv, folded) : arithValues(bin.op, lv, rv, folded);
+		if (err != ArithError::None) return;
+	}
+	else if (bin.op == BinaryOp::And) folded = Value::fromBool(lv.truthy() && rv.truthy());
+	else if (bin.op == BinaryOp::Or) folded = Value::fromBool(lv.truthy() || rv.truthy());
+	else folded = Value::fromBool(compareValues(bin.op, lv, rv));
+	// Like parsed literals, a folded str belongs to the arena, so runs of the
+	// program on several threads never touch its reference count.
+	if (folded.isStr()) folded = Value::fromImmortalStr(arena.make<StrObj>(folded.asStr(), StrObj::kImmortal));
+	e = arena.make<LiteralExpr>(std::move(folded));
+}
+
+Stmt* Optimizer::optimizeStmt(Stmt* st) {
+	switch (st->kind) {
+		case StmtKind::VarDecl: {
+			auto& decl = static_cast<VarDeclStmt&>(*st);
+			if (decl.initExpr) foldExpr(decl.initExpr);
+			break;
+		}
+		case StmtKind::Assign:
+			foldExpr(static_cast<AssignStmt&>(*st).expr);
+			break;
+		case StmtKind::Block:
+			optimizeBlock(static_cast<BlockStmt&>(*st));
+			break;
+		case StmtKind::If: {
+			auto& ifs = static_cast<IfStmt&>(*st);
+			foldExpr(ifs.condition);
+			optimizeBlock(*ifs.thenBlock);
+			if (ifs.elseBlock) optimizeBlock(*ifs.elseBlock);
+			if (!isLiteral(*ifs.condition)) break;
+			if (literalValue(*ifs.condition).truthy()) return ifs.thenBlock;
+			return ifs.elseBlock;
+		}
+		case StmtKind::While: {
+			auto& loop = static_cast<WhileStmt&>(*st);
+			foldExpr(loop.condition);
+			optimizeBlock(*loop.body);
+			if (loop.step) loop.step = optimizeStmt(loop.step);
+			if (isLiteral(*loop.condition) && !literalValue(*loop.condition).truthy()) return nullptr;
+			break;
+		}
+		case StmtKind::Print:
+		case StmtKind::Read:
+		case StmtKind::TimeExec:
+			break;
+	}
+	return st;
+}
+
+void Optimizer::optimizeBlock(BlockStmt& block) {
+	// Rewrites the statement array in place; it can only shrink.
+	size_t out = 0;
+	for (size_t i = 0; i < block.statements.size(); ++i) {
+		Stmt* st = optimizeStmt(block.statements[i]);
+		if (!st) continue;
+		if (st->kind == StmtKind::Block && static_cast<BlockStmt*>(st)->statements.empty()) continue;
+		if (st->kind == StmtKind::Print && out > 0 && block.statements[out - 1]->kind == StmtKind::Print) {
+			auto* prev = static_cast<PrintStmt*>(block.statements[out - 1]);
+			auto* cur = static_cast<PrintStmt*>(st);
+			if (isPlainText(*prev) && isPlainText(*cur)) {
+				std::string merged;
+				for (const auto& part : prev->parts) merged += part.text;
+				merged += '\n';
+				for (const auto& part : cur->parts) merged += part.text;
+				auto* part = arena.make<PrintPart>();
+				part->text = arena.intern(merged);
+				prev->parts.data = part;
+				prev->parts.count = 1;
+				continue;
+			}
+		}
+		block.statements[out++] = st;
+	}
+	block.statements.count = out;
+}
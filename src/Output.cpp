@@ -0,0 +1,80 @@
+#include "Output.h"
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kBufferSize = 64 * 1024;
+
+struct StdoutSink {
+	std::string buffer;
+	Out::FlushPolicy policy;
+	bool stdinIsTty;
+	StdoutSink()
+		: policy(isatty(STDOUT_FILENO) ? Out::FlushPolicy::Line : Out::FlushPolicy::Full),
+		  stdinIsTty(isatty(STDIN_FILENO) != 0) {
+		buffer.reserve(kBufferSize);
+	}
+	// Whatever is still buffered when the program ends is written out here.
+	~StdoutSink() { drain(); }
+	void drain() {
+		if (buffer.empty()) return;
+		std::cout.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		std::cout.flush();
+		buffer.clear();
+	}
+};
+
+StdoutSink& sink() {
+	static StdoutSink s;
+	return s;
+}
+
+// beginThread(); at most one of them is set
+thread_local std::string* threadBuffer = nullptr;
+thread_local const Out::Sink* threadSink = nullptr;
+
+} // namespace
+
+void Out::setFlushPolicy(FlushPolicy policy) {
+	sink().drain();
+	sink().policy = policy;
+}
+
+Out::FlushPolicy Out::flushPolicy() { return sink().policy; }
+
+void Out::write(std::string_view s) {
+	if (threadBuffer) { threadBuffer->append(s); return; }
+	if (threadSink) { (*threadSink)(s); return; }
+	StdoutSink& out = sink();
+	out.buffer.append(s);
+	if (out.policy == FlushPolicy::Always || out.buffer.size() >= kBufferSize) out.drain();
+}
+
+void Out::line(std::string_view s) {
+	if (threadBuffer) { threadBuffer->append(s); *threadBuffer += '\n'; return; }
+	if (threadSink) { (*threadSink)(s); (*threadSink)("\n"); return; }
+	StdoutSink& out = sink();
+	out.buffer.append(s);
+	out.buffer += '\n';
+	if (out.policy != FlushPolicy::Full || out.buffer.size() >= kBufferSize) out.drain();
+}
+
+static bool redirected() { return threadBuffer || threadSink; }
+
+void Out::flush() {
+	if (!redirected()) sink().drain();
+}
+
+void Out::flushBeforeRead() {
+	if (!redirected() && sink().stdinIsTty) sink().drain();
+}
+
+void Out::beginThread(std::string& buffer) { threadBuffer = &buffer; }
+void Out::beginThread(const Sink& s) { threadSink = &s; }
+
+void Out::endThread() {
+	threadBuffer = nullptr;
+	threadSink = nullptr;
+}
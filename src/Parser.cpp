@@ -1,7 +1,8 @@
 #include "Parser.h"
+#include "Numeric.h"
 #include <sstream>
 
-static bool match(const std::vector<Token>& t, size_t& i, TokenType type) {
+static bool match(TokenSpan t, size_t& i, TokenType type) {
 	if (i < t.size() && t[i].type == type) { i++; return true; }
 	return false;
 }
@@ -12,7 +13,26 @@ static std::string tokDesc(const Token& tk) {
 	return os.str();
 }
 
-std::unique_ptr<Expr> Parser::parseTerm(const std::vector<Token>& t, size_t& i, std::string& errorMsg) {
+// Operator of a binary or compound-assignment token.
+static BinaryOp binaryOp(TokenType type) {
+	switch (type) {
+		case TokenType::Plus: case TokenType::PlusEqual: return BinaryOp::Add;
+		case TokenType::Minus: case TokenType::MinusEqual: return BinaryOp::Sub;
+		case TokenType::Star: case TokenType::StarEqual: return BinaryOp::Mul;
+		case TokenType::Slash: case TokenType::SlashEqual: return BinaryOp::Div;
+		case TokenType::Percent: case TokenType::PercentEqual: return BinaryOp::Mod;
+		case TokenType::EqualEqual: return BinaryOp::Eq;
+		case TokenType::BangEqual: return BinaryOp::Ne;
+		case TokenType::Less: return BinaryOp::Lt;
+		case TokenType::LessEqual: return BinaryOp::Le;
+		case TokenType::Greater: return BinaryOp::Gt;
+		case TokenType::GreaterEqual: return BinaryOp::Ge;
+		case TokenType::AndAnd: return BinaryOp::And;
+		default: return BinaryOp::Or;
+	}
+}
+
+Expr* Parser::parseTerm(TokenSpan t, size_t& i, std::string& errorMsg) {
 	if (i >= t.size()) { errorMsg = "unexpected end of input"; return nullptr; }
 	if (t[i].type == TokenType::LParen) {
 		i++;
@@ -22,131 +42,344 @@ std::unique_ptr<Expr> Parser::parseTerm(const std::vector<Token>& t, size_t& i,
 		i++;
 		return e;
 	}
-	if (t[i].type == TokenType::IntLiteral) { auto e = std::make_unique<IntLiteralExpr>(t[i].lexeme); i++; return e; }
-	if (t[i].type == TokenType::FloatLiteral) { auto e = std::make_unique<FloatLiteralExpr>(t[i].lexeme); i++; return e; }
-	if (t[i].type == TokenType::StrLiteral) { auto e = std::make_unique<StrLiteralExpr>(t[i].lexeme); i++; return e; }
-	if (t[i].type == TokenType::Identifier) { auto e = std::make_unique<IdentifierExpr>(t[i].lexeme); i++; return e; }
+	if (t[i].type == TokenType::IntLiteral) {
+		std::string_view lex = t[i].lexeme;
+		int64_t v = 0;
+		if (!Numeric::parseInt(lex, v)) { errorMsg = "integer literal out of range: " + std::string(lex); return nullptr; }
+		i++;
+		return arena->make<LiteralExpr>(Value::fromInt(v));
+	}
+	if (t[i].type == TokenType::FloatLiteral) {
+		std::string_view lex = t[i].lexeme;
+		double v = 0;
+		if (!Numeric::parseFloat(lex, v)) { errorMsg = "float literal out of range: " + std::string(lex); return nullptr; }
+		i++;
+		return arena->make<LiteralExpr>(Value::fromFloat(v));
+	}
+	if (t[i].type == TokenType::StrLiteral) {
+		auto* str = arena->make<StrObj>(std::string(t[i].lexeme), StrObj::kImmortal);
+		i++;
+		return arena->make<LiteralExpr>(Value::fromImmortalStr(str));
+	}
+	if (t[i].type == TokenType::Identifier) { auto e = arena->make<IdentifierExpr>(arena->intern(t[i].lexeme)); i++; return e; }
 	errorMsg = std::string("expected literal or identifier, got ") + tokDesc(t[i]);
 	return nullptr;
 }
 
-std::unique_ptr<Expr> Parser::parseUnary(const std::vector<Token>& t, size_t& i, std::string& errorMsg) {
-	if (i < t.size() && t[i].type == TokenType::Bang) { i++; auto e = parseUnary(t, i, errorMsg); if (!e) return nullptr; return std::make_unique<UnaryExpr>("!", std::move(e)); }
+Expr* Parser::parseUnary(TokenSpan t, size_t& i, std::string& errorMsg) {
+	if (i < t.size() && t[i].type == TokenType::Bang) { i++; auto e = parseUnary(t, i, errorMsg); if (!e) return nullptr; return makeUnary(*arena, UnaryOp::Not, e); }
+	if (i < t.size() && t[i].type == TokenType::Minus) { i++; auto e = parseUnary(t, i, errorMsg); if (!e) return nullptr; return makeUnary(*arena, UnaryOp::Neg, e); }
 	return parseTerm(t, i, errorMsg);
 }
 
-std::unique_ptr<Expr> Parser::parseAdditive(const std::vector<Token>& t, size_t& i, std::string& errorMsg) {
+Expr* Parser::parseMultiplicative(TokenSpan t, size_t& i, std::string& errorMsg) {
 	auto left = parseUnary(t, i, errorMsg);
 	if (!left) return nullptr;
-	while (i < t.size() && (t[i].type == TokenType::Plus)) {
-		std::string op = t[i].lexeme; i++;
+	while (i < t.size() && (t[i].type == TokenType::Star || t[i].type == TokenType::Slash || t[i].type == TokenType::Percent)) {
+		BinaryOp op = binaryOp(t[i].type); i++;
 		auto right = parseUnary(t, i, errorMsg);
 		if (!right) return nullptr;
-		left = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
+		left = makeBinary(*arena, op, left, right);
 	}
 	return left;
 }
 
-std::unique_ptr<Expr> Parser::parseComparison(const std::vector<Token>& t, size_t& i, std::string& errorMsg) {
+Expr* Parser::parseAdditive(TokenSpan t, size_t& i, std::string& errorMsg) {
+	auto left = parseMultiplicative(t, i, errorMsg);
+	if (!left) return nullptr;
+	while (i < t.size() && (t[i].type == TokenType::Plus || t[i].type == TokenType::Minus)) {
+		BinaryOp op = binaryOp(t[i].type); i++;
+		auto right = parseMultiplicative(t, i, errorMsg);
+		if (!right) return nullptr;
+		left = makeBinary(*arena, op, left, right);
+	}
+	return left;
+}
+
+Expr* Parser::parseComparison(TokenSpan t, size_t& i, std::string& errorMsg) {
 	auto left = parseAdditive(t, i, errorMsg);
 	if (!left) return nullptr;
 	while (i < t.size() && (t[i].type == TokenType::Less || t[i].type == TokenType::LessEqual || t[i].type == TokenType::Greater || t[i].type == TokenType::GreaterEqual)) {
-		std::string op = t[i].lexeme; i++;
+		BinaryOp op = binaryOp(t[i].type); i++;
 		auto right = parseAdditive(t, i, errorMsg);
 		if (!right) return nullptr;
-		left = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
+		left = makeBinary(*arena, op, left, right);
 	}
 	return left;
 }
 
-std::unique_ptr<Expr> Parser::parseEquality(const std::vector<Token>& t, size_t& i, std::string& errorMsg) {
+Expr* Parser::parseEquality(TokenSpan t, size_t& i, std::string& errorMsg) {
 	auto left = parseComparison(t, i, errorMsg);
 	if (!left) return nullptr;
 	while (i < t.size() && (t[i].type == TokenType::EqualEqual || t[i].type == TokenType::BangEqual)) {
-		std::string op = t[i].lexeme; i++;
+		BinaryOp op = binaryOp(t[i].type); i++;
 		auto right = parseComparison(t, i, errorMsg);
 		if (!right) return nullptr;
-		left = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
+		left = makeBinary(*arena, op, left, right);
 	}
 	return left;
 }
 
-std::unique_ptr<Expr> Parser::parseLogicalAnd(const std::vector<Token>& t, size_t& i, std::string& errorMsg) {
+Expr* Parser::parseLogicalAnd(TokenSpan t, size_t& i, std::string& errorMsg) {
 	auto left = parseEquality(t, i, errorMsg);
 	if (!left) return nullptr;
 	while (i < t.size() && t[i].type == TokenType::AndAnd) {
-		std::string op = t[i].lexeme; i++;
+		BinaryOp op = binaryOp(t[i].type); i++;
 		auto right = parseEquality(t, i, errorMsg);
 		if (!right) return nullptr;
-		left = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
+		left = makeBinary(*arena, op, left, right);
 	}
 	return left;
 }
 
-std::unique_ptr<Expr> Parser::parseLogicalOr(const std::vector<Token>& t, size_t& i, std::string& errorMsg) {
+Expr* Parser::parseLogicalOr(TokenSpan t, size_t& i, std::string& errorMsg) {
 	auto left = parseLogicalAnd(t, i, errorMsg);
 	if (!left) return nullptr;
 	while (i < t.size() && t[i].type == TokenType::OrOr) {
-		std::string op = t[i].lexeme; i++;
+		BinaryOp op = binaryOp(t[i].type); i++;
 		auto right = parseLogicalAnd(t, i, errorMsg);
 		if (!right) return nullptr;
-		left = std::make_unique<BinaryExpr>(op, std::move(left), std::move(right));
+		left = makeBinary(*arena, op, left, right);
 	}
 	return left;
 }
 
-std::unique_ptr<Expr> Parser::parseExpression(const std::vector<Token>& t, size_t& i, std::string& errorMsg) {
+Expr* Parser::parseExpression(TokenSpan t, size_t& i, std::string& errorMsg) {
 	return parseLogicalOr(t, i, errorMsg);
 }
 
-std::unique_ptr<Expr> Parser::parseExpr(const std::vector<Token>& tokens, size_t start, size_t end, std::string& errorMsg) {
+Expr* Parser::parseExpr(TokenSpan tokens, size_t start, size_t end, std::string& errorMsg) {
 	if (start >= end) { errorMsg = "empty expression"; return nullptr; }
-	std::vector<Token> sub;
-	sub.reserve(end - start + 1);
-	for (size_t k = start; k < end; ++k) sub.push_back(tokens[k]);
-	sub.push_back({TokenType::EndOfInput, ""});
 	size_t idx = 0;
-	auto e = parseExpression(sub, idx, errorMsg);
-	if (!e) return nullptr;
-	return e;
+	return parseExpression(tokens.sub(start, end), idx, errorMsg);
+}
+
+// Splits print() text into literal runs and {name} placeholders. A '{'
+// without a later '}' is plain text.
+ArenaArray<PrintPart> Parser::splitTemplate(std::string_view content) {
+	partScratch.clear();
+	size_t pos = 0;
+	while (pos < content.size()) {
+		size_t open = content.find('{', pos);
+		size_t close = open == std::string_view::npos ? std::string_view::npos : content.find('}', open);
+		if (close == std::string_view::npos) {
+			partScratch.push_back({arena->intern(content.substr(pos)), false, -1});
+			break;
+		}
+		if (open > pos) partScratch.push_back({arena->intern(content.substr(pos, open - pos)), false, -1});
+		partScratch.push_back({arena->intern(content.substr(open + 1, close - open - 1)), true, -1});
+		pos = close + 1;
+	}
+	return arena->copyArray(partScratch);
+}
+
+// Moves the statements collected on the scratch stack since mark into a new
+// arena-owned block.
+BlockStmt* Parser::finishBlock(size_t mark) {
+	auto block = arena->make<BlockStmt>();
+	block->statements = arena->copyArray(scratch, mark);
+	scratch.resize(mark);
+	return block;
+}
+
+Stmt* Parser::parseStatement(TokenSpan t, size_t& i, std::string& errorMsg) {
+	size_t start = i;
+	auto st = parseSimpleStatement(t, i, errorMsg);
+	if (st && start < t.size()) st->line = t[start].line;
+	return st;
+}
+
+BlockStmt* Parser::parseBlock(TokenSpan t, size_t& i, std::string& errorMsg) {
+	if (!match(t, i, TokenType::LBrace)) { errorMsg = "expected '{'"; return nullptr; }
+	size_t mark = scratch.size();
+	while (true) {
+		if (i >= t.size() || t[i].type == TokenType::EndOfInput) { errorMsg = "expected '}' before end of input"; return nullptr; }
+		if (match(t, i, TokenType::RBrace)) break;
+		if (match(t, i, TokenType::Semicolon)) continue;
+		auto st = parseStatement(t, i, errorMsg);
+		if (!st) return nullptr;
+		scratch.push_back(st);
+	}
+	return finishBlock(mark);
+}
+
+Stmt* Parser::parseIf(TokenSpan t, size_t& i, std::string& errorMsg) {
+	// if (cond) { ... } [else if (cond) { ... }]* [else { ... }]
+	size_t start = i;
+	if (!match(t, i, TokenType::KeywordIf)) return nullptr;
+	if (!match(t, i, TokenType::LParen)) { errorMsg = "expected '(' after if"; return nullptr; }
+	auto cond = parseExpression(t, i, errorMsg);
+	if (!cond) return nullptr;
+	if (!match(t, i, TokenType::RParen)) { errorMsg = "expected ')' after if condition"; return nullptr; }
+	auto thenBlock = parseBlock(t, i, errorMsg);
+	if (!thenBlock) return nullptr;
+	BlockStmt* elseBlock = nullptr;
+	if (match(t, i, TokenType::KeywordElse)) {
+		if (i < t.size() && t[i].type == TokenType::KeywordIf) {
+			size_t elseIfStart = i;
+			auto elseIf = parseIf(t, i, errorMsg);
+			if (!elseIf) return nullptr;
+			elseIf->line = t[elseIfStart].line;
+			size_t mark = scratch.size();
+			scratch.push_back(elseIf);
+			elseBlock = finishBlock(mark);
+		} else {
+			elseBlock = parseBlock(t, i, errorMsg);
+			if (!elseBlock) return nullptr;
+		}
+	}
+	auto st = arena->make<IfStmt>(cond, thenBlock, elseBlock);
+	st->line = t[start].line;
+	return st;
+}
+
+Stmt* Parser::parseWhile(TokenSpan t, size_t& i, std::string& errorMsg) {
+	// while (cond) { ... }
+	size_t start = i;
+	if (!match(t, i, TokenType::KeywordWhile)) return nullptr;
+	if (!match(t, i, TokenType::LParen)) { errorMsg = "expected '(' after while"; return nullptr; }
+	auto cond = parseExpression(t, i, errorMsg);
+	if (!cond) return nullptr;
+	if (!match(t, i, TokenType::RParen)) { errorMsg = "expected ')' after while condition"; return nullptr; }
+	auto body = parseBlock(t, i, errorMsg);
+	if (!body) return nullptr;
+	auto st = arena->make<WhileStmt>(cond, body, nullptr);
+	st->line = t[start].line;
+	return st;
+}
+
+Stmt* Parser::parseFor(TokenSpan t, size_t& i, std::string& errorMsg) {
+	// for ([init]; [cond]; [step]) { ... }  ->  { init; while (cond) { ... } step }
+	size_t start = i;
+	if (!match(t, i, TokenType::KeywordFor)) return nullptr;
+	if (!match(t, i, TokenType::LParen)) { errorMsg = "expected '(' after for"; return nullptr; }
+	Stmt* init = nullptr;
+	if (!match(t, i, TokenType::Semicolon)) {
+		bool isDecl = i < t.size() && (t[i].type == TokenType::KeywordInt || t[i].type == TokenType::KeywordStr || t[i].type == TokenType::KeywordFloat || t[i].type == TokenType::KeywordAuto);
+		init = isDecl ? parseStatement(t, i, errorMsg) : parseAssignment(t, i, errorMsg);
+		if (!init) { if (errorMsg.empty()) errorMsg = "expected declaration or assignment in for"; return nullptr; }
+		if (!isDecl) match(t, i, TokenType::Semicolon);
+		if (t[i - 1].type != TokenType::Semicolon) { errorMsg = "expected ';' after for initializer"; return nullptr; }
+	}
+	Expr* cond = nullptr;
+	if (i < t.size() && t[i].type != TokenType::Semicolon) {
+		cond = parseExpression(t, i, errorMsg);
+		if (!cond) return nullptr;
+	} else {
+		cond = arena->make<LiteralExpr>(Value::fromBool(true));
+	}
+	if (!match(t, i, TokenType::Semicolon)) { errorMsg = "expected ';' after for condition"; return nullptr; }
+	Stmt* step = nullptr;
+	if (i < t.size() && t[i].type != TokenType::RParen) {
+		step = parseAssignment(t, i, errorMsg);
+		if (!step) { if (errorMsg.empty()) errorMsg = "expected assignment in for step"; return nullptr; }
+	}
+	if (!match(t, i, TokenType::RParen)) { errorMsg = "expected ')' after for clauses"; return nullptr; }
+	auto body = parseBlock(t, i, errorMsg);
+	if (!body) return nullptr;
+	auto loop = arena->make<WhileStmt>(cond, body, step);
+	loop->line = t[start].line;
+	size_t mark = scratch.size();
+	if (init) scratch.push_back(init);
+	scratch.push_back(loop);
+	return finishBlock(mark);
 }
 
-std::unique_ptr<Stmt> Parser::parseStatement(const std::vector<Token>& t, std::string& errorMsg) {
+// ident = expr, ident op= expr, ident++, ident--, ++ident, --ident. Compound
+// forms are rewritten as ident = ident op expr.
+Stmt* Parser::parseAssignment(TokenSpan t, size_t& i, std::string& errorMsg) {
+	size_t start = i;
+	bool prefix = match(t, i, TokenType::PlusPlus) || match(t, i, TokenType::MinusMinus);
+	BinaryOp prefixOp = prefix && t[i - 1].type == TokenType::MinusMinus ? BinaryOp::Sub : BinaryOp::Add;
+	if (i >= t.size() || t[i].type != TokenType::Identifier) {
+		if (prefix) errorMsg = "expected identifier after increment/decrement";
+		return nullptr;
+	}
+	std::string_view varName = arena->intern(t[i].lexeme); i++;
+	Expr* value = nullptr;
+	if (prefix) {
+		value = makeBinary(*arena, prefixOp, arena->make<IdentifierExpr>(varName), arena->make<LiteralExpr>(Value::fromInt(1)));
+	} else if (match(t, i, TokenType::PlusPlus) || match(t, i, TokenType::MinusMinus)) {
+		BinaryOp op = t[i - 1].type == TokenType::PlusPlus ? BinaryOp::Add : BinaryOp::Sub;
+		value = makeBinary(*arena, op, arena->make<IdentifierExpr>(varName), arena->make<LiteralExpr>(Value::fromInt(1)));
+	} else if (match(t, i, TokenType::Equals)) {
+		value = parseExpression(t, i, errorMsg);
+		if (!value) return nullptr;
+	} else if (i < t.size() && (t[i].type == TokenType::PlusEqual || t[i].type == TokenType::MinusEqual || t[i].type == TokenType::StarEqual || t[i].type == TokenType::SlashEqual || t[i].type == TokenType::PercentEqual)) {
+		BinaryOp op = binaryOp(t[i].type); i++;
+		auto rhs = parseExpression(t, i, errorMsg);
+		if (!rhs) return nullptr;
+		value = makeBinary(*arena, op, arena->make<IdentifierExpr>(varName), rhs);
+	} else {
+		errorMsg = "expected '=' after identifier";
+		return nullptr;
+	}
+	auto st = arena->make<AssignStmt>(varName, value);
+	st->line = t[start].line;
+	return st;
+}
+
+BlockStmt* Parser::parseProgram(TokenSpan t, std::string& errorMsg) {
 	size_t i = 0;
+	errorLine_ = 0;
+	scratch.clear();
+	while (i < t.size() && t[i].type != TokenType::EndOfInput) {
+		if (match(t, i, TokenType::Semicolon)) continue;
+		if (t[i].type == TokenType::RBrace) {
+			errorMsg = "unexpected '}'";
+			errorLine_ = t[i].line;
+			return nullptr;
+		}
+		auto st = parseStatement(t, i, errorMsg);
+		if (!st) {
+			errorLine_ = t[i < t.size() ? i : t.size() - 1].line;
+			return nullptr;
+		}
+		scratch.push_back(st);
+	}
+	return finishBlock(0);
+}
+
+Stmt* Parser::parseSimpleStatement(TokenSpan t, size_t& i, std::string& errorMsg) {
+	if (i < t.size() && t[i].type == TokenType::KeywordIf) return parseIf(t, i, errorMsg);
+	if (i < t.size() && t[i].type == TokenType::KeywordWhile) return parseWhile(t, i, errorMsg);
+	if (i < t.size() && t[i].type == TokenType::KeywordFor) return parseFor(t, i, errorMsg);
+
 	// print("...");
 	if (match(t, i, TokenType::KeywordPrint)) {
 		if (!match(t, i, TokenType::LParen)) return nullptr;
 		if (i >= t.size()) { errorMsg = "expected string literal in print(...)"; return nullptr; }
 		if (t[i].type != TokenType::StrLiteral) { errorMsg = "print currently accepts only string literals"; return nullptr; }
-		std::string content = t[i].lexeme; i++;
+		auto parts = splitTemplate(t[i].lexeme); i++;
 		if (!match(t, i, TokenType::RParen)) return nullptr;
 		match(t, i, TokenType::Semicolon);
-		return std::make_unique<PrintStmt>(content);
+		return arena->make<PrintStmt>(parts);
 	}
 
 	// read(ident);
 	if (match(t, i, TokenType::KeywordRead)) {
 		if (!match(t, i, TokenType::LParen)) return nullptr;
 		if (i >= t.size() || t[i].type != TokenType::Identifier) { errorMsg = "expected identifier in read(...)"; return nullptr; }
-		std::string name = t[i].lexeme; i++;
+		std::string_view name = arena->intern(t[i].lexeme); i++;
 		if (!match(t, i, TokenType::RParen)) return nullptr;
 		match(t, i, TokenType::Semicolon);
-		return std::make_unique<ReadStmt>(name);
+		return arena->make<ReadStmt>(name);
 	}
 
 	// var decl: int|str|float|auto name [= expr] ( , name [= expr] )* ;
 	if (i < t.size() && (t[i].type == TokenType::KeywordInt || t[i].type == TokenType::KeywordStr || t[i].type == TokenType::KeywordFloat || t[i].type == TokenType::KeywordAuto)) {
-		std::string typeName = "";
+		std::string_view typeName;
 		if (t[i].type == TokenType::KeywordInt) typeName = "int";
 		else if (t[i].type == TokenType::KeywordStr) typeName = "str";
 		else if (t[i].type == TokenType::KeywordFloat) typeName = "float";
 		else if (t[i].type == TokenType::KeywordAuto) typeName = "auto";
 		i++;
 		if (i >= t.size() || t[i].type != TokenType::Identifier) { errorMsg = "expected variable name after type"; return nullptr; }
-		auto block = std::make_unique<BlockStmt>();
+		size_t mark = scratch.size();
 		while (true) {
-			std::string varName = t[i].lexeme; i++;
-			std::unique_ptr<Expr> initExpr;
+			int declLine = t[i].line;
+			std::string_view varName = arena->intern(t[i].lexeme); i++;
+			Expr* initExpr = nullptr;
 			if (match(t, i, TokenType::Equals)) {
 				initExpr = parseExpression(t, i, errorMsg);
 				if (!initExpr) return nullptr;
@@ -154,7 +387,9 @@ std::unique_ptr<Stmt> Parser::parseStatement(const std::vector<Token>& t, std::s
 				errorMsg = "auto requires an initializer";
 				return nullptr;
 			}
-			block->statements.push_back(std::make_unique<VarDeclStmt>(typeName, varName, std::move(initExpr)));
+			auto decl = arena->make<VarDeclStmt>(typeName, varName, initExpr);
+			decl->line = declLine;
+			scratch.push_back(decl);
 			if (match(t, i, TokenType::Comma)) {
 				if (i >= t.size() || t[i].type != TokenType::Identifier) { errorMsg = "expected variable name after ','"; return nullptr; }
 				continue;
@@ -162,7 +397,7 @@ std::unique_ptr<Stmt> Parser::parseStatement(const std::vector<Token>& t, std::s
 			break;
 		}
 		match(t, i, TokenType::Semicolon);
-		return block;
+		return finishBlock(mark);
 	}
 
 	// timeexec();
@@ -171,18 +406,15 @@ std::unique_ptr<Stmt> Parser::parseStatement(const std::vector<Token>& t, std::s
 		if (!match(t, i, TokenType::LParen)) { errorMsg = "expected '(' after timeexec"; return nullptr; }
 		if (!match(t, i, TokenType::RParen)) { errorMsg = "expected ')' in timeexec()"; return nullptr; }
 		match(t, i, TokenType::Semicolon);
-		if (!timeExecFlag) { errorMsg = "timeexec() unavailable"; return nullptr; }
-		return std::make_unique<TimeExecStmt>(*timeExecFlag);
+		return arena->make<TimeExecStmt>();
 	}
 
-	// assignment: ident = expr;
-	if (i < t.size() && t[i].type == TokenType::Identifier) {
-		std::string varName = t[i].lexeme; i++;
-		if (!match(t, i, TokenType::Equals)) { errorMsg = "expected '=' after identifier"; return nullptr; }
-		auto e = parseExpression(t, i, errorMsg);
-		if (!e) return nullptr;
+	// assignment: ident = expr; (also compound assignments, ++ and --)
+	if (i < t.size() && (t[i].type == TokenType::Identifier || t[i].type == TokenType::PlusPlus || t[i].type == TokenType::MinusMinus)) {
+		auto st = parseAssignment(t, i, errorMsg);
+		if (!st) return nullptr;
 		match(t, i, TokenType::Semicolon);
-		return std::make_unique<AssignStmt>(varName, std::move(e));
+		return st;
 	}
 
 	return nullptr;
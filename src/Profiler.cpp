@@ -0,0 +1,142 @@
+#include "Profiler.h"
+#include "AST.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sys/time.h>
+
+static Profiler* g_sampling = nullptr; // profiler receiving timer samples
+
+static const char* stmtName(StmtKind kind) {
+	switch (kind) {
+		case StmtKind::VarDecl: return "decl";
+		case StmtKind::Assign: return "assign";
+		case StmtKind::Print: return "print";
+		case StmtKind::Read: return "read";
+		case StmtKind::Block: return "block";
+		case StmtKind::If: return "if";
+		case StmtKind::While: return "while";
+		case StmtKind::TimeExec: return "timeexec";
+	}
+	return "?";
+}
+
+void Profiler::registerProgram(Stmt& program) {
+	registerStmt(program, -1);
+}
+
+void Profiler::registerStmt(Stmt& st, int parent) {
+	if (st.kind == StmtKind::Block) {
+		for (Stmt* child : static_cast<BlockStmt&>(st).statements) registerStmt(*child, parent);
+		return;
+	}
+	uint8_t evalsPerRun = 0;
+	if (st.kind == StmtKind::Assign || st.kind == StmtKind::If) evalsPerRun = 1;
+	else if (st.kind == StmtKind::VarDecl && static_cast<VarDeclStmt&>(st).initExpr) evalsPerRun = 1;
+	// while counts one evaluation per condition check instead
+	st.site = static_cast<int>(sites.size());
+	sites.push_back({stmtName(st.kind), st.line, parent, evalsPerRun});
+	if (st.kind == StmtKind::If) {
+		auto& ifs = static_cast<IfStmt&>(st);
+		registerStmt(*ifs.thenBlock, st.site);
+		if (ifs.elseBlock) registerStmt(*ifs.elseBlock, st.site);
+	} else if (st.kind == StmtKind::While) {
+		auto& loop = static_cast<WhileStmt&>(st);
+		registerStmt(*loop.body, st.site);
+		if (loop.step) registerStmt(*loop.step, st.site);
+	}
+}
+
+void Profiler::onSample(int) {
+	Profiler* p = g_sampling;
+	if (!p) return;
+	int site = p->current;
+	if (site >= 0) p->sites[site].hits++;
+	else p->rootHits++;
+}
+
+void Profiler::start() {
+	current = -1;
+	g_sampling = this;
+	struct sigaction sa = {};
+	sa.sa_handler = onSample;
+	sa.sa_flags = SA_RESTART; // do not interrupt read() waiting on input
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGALRM, &sa, nullptr);
+	itimerval timer = {};
+	timer.it_interval.tv_usec = static_cast<suseconds_t>(kSampleInterval.count());
+	timer.it_value = timer.it_interval;
+	setitimer(ITIMER_REAL, &timer, nullptr);
+	wallStart = std::chrono::steady_clock::now();
+}
+
+void Profiler::stop() {
+	totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+	itimerval off = {};
+	setitimer(ITIMER_REAL, &off, nullptr);
+	g_sampling = nullptr;
+	current = -1;
+}
+
+bool Profiler::execute(Stmt& st, Frame& frame) {
+	enter(st.site);
+	bool ok = st.execute(frame);
+	leave(st.site);
+	return ok;
+}
+
+std::vector<uint64_t> Profiler::inclusiveHits() const {
+	// Children are registered after their parent, so one backwards pass
+	// accumulates every subtree.
+	std::vector<uint64_t> incl(sites.size());
+	for (size_t i = 0; i < sites.size(); ++i) incl[i] = sites[i].hits;
+	for (size_t i = sites.size(); i-- > 0;)
+		if (sites[i].parent >= 0) incl[sites[i].parent] += incl[i];
+	return incl;
+}
+
+double Profiler::hitsToMs(uint64_t hits) const {
+	uint64_t total = rootHits;
+	for (const Site& s : sites) total += s.hits;
+	return total ? totalMs * static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+}
+
+void Profiler::report(std::ostream& os) const {
+	std::vector<uint64_t> incl = inclusiveHits();
+	std::vector<size_t> order;
+	for (size_t i = 0; i < sites.size(); ++i)
+		if (sites[i].count > 0) order.push_back(i);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sites[a].hits > sites[b].hits; });
+
+	os << "[profile] total " << std::fixed << std::setprecision(3) << totalMs << " ms, sampled every "
+	   << kSampleInterval.count() << " us\n";
+	os << std::setw(6) << "line" << "  " << std::left << std::setw(9) << "stmt" << std::right
+	   << std::setw(12) << "count" << std::setw(12) << "evals"
+	   << std::setw(12) << "incl ms" << std::setw(12) << "self ms" << std::setw(8) << "self%" << "\n";
+	for (size_t i : order) {
+		const Site& s = sites[i];
+		double self = hitsToMs(s.hits);
+		os << std::setw(6) << s.line << "  " << std::left << std::setw(9) << s.what << std::right
+		   << std::setw(12) << s.count << std::setw(12) << s.evals
+		   << std::setw(12) << std::setprecision(3) << hitsToMs(incl[i])
+		   << std::setw(12) << self
+		   << std::setw(8) << std::setprecision(1) << (totalMs > 0 ? 100.0 * self / totalMs : 0.0) << "\n";
+	}
+}
+
+bool Profiler::writeCollapsed(const std::string& path, std::string& errorMsg) const {
+	std::ofstream out(path);
+	if (!out) { errorMsg = "cannot write " + path; return false; }
+	std::vector<int> chain;
+	if (rootHits) out << "program " << static_cast<uint64_t>(hitsToMs(rootHits) * 1000.0) << '\n';
+	for (size_t i = 0; i < sites.size(); ++i) {
+		if (sites[i].hits == 0) continue;
+		chain.clear();
+		for (int s = static_cast<int>(i); s >= 0; s = sites[s].parent) chain.push_back(s);
+		out << "program";
+		for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+			out << ';' << sites[*it].what << '@' << sites[*it].line;
+		out << ' ' << static_cast<uint64_t>(hitsToMs(sites[i].hits) * 1000.0) << '\n';
+	}
+	return static_cast<bool>(out);
+}
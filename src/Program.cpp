@@ -0,0 +1,110 @@
+#include "Program.h"
+#include "Error.h"
+#include "Input.h"
+#include "Interpreter.h"
+#include "Output.h"
+#include <sstream>
+
+struct Program::Impl {
+	Interpreter interp;
+};
+
+struct Context::Impl {
+	explicit Impl(const Program& p) : program(p) {}
+	const Program& program;
+	Frame frame;
+	VM vm;
+	Input input;
+	Output output;
+	std::string line; // last line handed to read()
+	std::ostringstream diagnostics;
+	std::string errors;
+};
+
+static ::Engine internalEngine(Program::Engine engine) {
+	return engine == Program::Engine::VM ? ::Engine::VM : ::Engine::Tree;
+}
+
+static Jit::Mode internalJitMode(Program::JitMode mode) {
+	if (!Jit::available()) return Jit::Mode::Off;
+	switch (mode) {
+		case Program::JitMode::On: return Jit::Mode::On;
+		case Program::JitMode::Verify: return Jit::Mode::Verify;
+		case Program::JitMode::Off: break;
+	}
+	return Jit::Mode::Off;
+}
+
+Program::Program() : impl(new Impl()) {}
+
+Program::~Program() = default;
+
+std::unique_ptr<Program> Program::compile(std::string_view source, std::string& errorMsg) {
+	return compile(source, Options(), errorMsg);
+}
+
+std::unique_ptr<Program> Program::compile(std::string_view source, const Options& options, std::string& errorMsg) {
+	std::unique_ptr<Program> program(new Program());
+	Interpreter& interp = program->impl->interp;
+	interp.setEngine(internalEngine(options.engine));
+	interp.setOptimize(options.optimize);
+	interp.setJit(internalJitMode(options.jit));
+	std::ostringstream diagnostics;
+	Err::beginThread(diagnostics);
+	Err::setCurrentLine(0);
+	bool ok = interp.compile(source);
+	Err::endThread();
+	errorMsg = diagnostics.str();
+	if (!errorMsg.empty() && errorMsg.back() == '\n') errorMsg.pop_back();
+	if (!ok) return nullptr;
+	return program;
+}
+
+Context::Context(const Program& p) : impl(new Impl(p)) {
+	p.impl->interp.initFrame(impl->frame);
+}
+
+Context::~Context() = default;
+
+void Context::setInput(Input in) { impl->input = std::move(in); }
+
+void Context::setOutput(Output out) { impl->output = std::move(out); }
+
+const std::string& Context::errors() const { return impl->errors; }
+
+bool Context::timeExecRequested() const { return impl->frame.timeExec; }
+
+bool Context::run() {
+	Impl& state = *impl;
+	In::Provider nextLine = [&state]() -> std::string_view {
+		if (!state.input || !state.input(state.line)) state.line.clear();
+		return state.line;
+	};
+	Out::Sink sink = [&state](std::string_view text) {
+		if (state.output) state.output(text);
+	};
+	state.frame.reset();
+	In::beginThread(nextLine);
+	Out::beginThread(sink);
+	Err::beginThread(state.diagnostics);
+	Err::setCurrentLine(0);
+	bool ok = state.program.impl->interp.runIn(state.frame, state.vm);
+	Err::endThread();
+	Out::endThread();
+	In::endThread();
+	state.errors = state.diagnostics.str();
+	state.diagnostics.str("");
+	return ok;
+}
+
+bool Context::variable(std::string_view name, std::string& text) const {
+	const Frame& frame = impl->frame;
+	const auto& names = impl->program.impl->interp.symbolTable().names;
+	for (size_t slot = 0; slot < names.size(); ++slot) {
+		if (names[slot] != name) continue;
+		if (frame.types[slot] == VarType::Undeclared) return false;
+		text = frame.values[slot].toString();
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,476 @@
+#include "ProgramCache.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+// File layout (native byte order, checked through kByteOrderMark):
+//   header  magic[8] version:u32 byteOrder:u32 sourceHash:u64 optimized:u8
+//           payloadSize:u64 payloadHash:u64
+//   payload strings:u32 {len:u32 bytes}*  symbols:u32 {name:u32 declared:u8}*
+//           root statement, nodes in preorder
+static const char kMagic[8] = {'B', 'P', 'C', 'A', 'C', 'H', 'E', '\0'};
+static constexpr uint32_t kVersion = 3; // bump whenever the node encoding changes
+static constexpr uint32_t kByteOrderMark = 0x01020304;
+static constexpr size_t kHeaderSize = 8 + 4 + 4 + 8 + 1 + 8 + 8;
+
+static uint64_t hashBytes(const char* p, size_t n, uint64_t seed) {
+	const uint64_t mul = 0xff51afd7ed558ccdull;
+	uint64_t h = seed ^ (n * 0x9e3779b97f4a7c15ull);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		uint64_t w;
+		std::memcpy(&w, p + i, 8);
+		h = (h ^ w) * mul;
+		h ^= h >> 32;
+	}
+	uint64_t tail = 0;
+	std::memcpy(&tail, p + i, n - i);
+	h = (h ^ tail) * mul;
+	h ^= h >> 29;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	return h ^ (h >> 32);
+}
+
+uint64_t ProgramCache::hashSource(std::string_view source) {
+	return hashBytes(source.data(), source.size(), 0x6270726f67ull);
+}
+
+std::string ProgramCache::pathInDir(const std::string& dir, uint64_t sourceHash, bool optimized) {
+	char name[32];
+	std::snprintf(name, sizeof name, "%016llx%s.bpc", static_cast<unsigned long long>(sourceHash), optimized ? "" : "-noopt");
+	if (dir.empty() || dir.back() == '/') return dir + name;
+	return dir + "/" + name;
+}
+
+namespace {
+
+class Writer {
+public:
+	std::string out;
+	void u8(uint8_t v) { out.push_back(static_cast<char>(v)); }
+	void u32(uint32_t v) { raw(&v, sizeof v); }
+	void i32(int32_t v) { raw(&v, sizeof v); }
+	void u64(uint64_t v) { raw(&v, sizeof v); }
+	void raw(const void* p, size_t n) { out.append(static_cast<const char*>(p), n); }
+};
+
+// Every read is bounds-checked; once anything is out of range ok turns false
+// and all further reads return zeros.
+class Reader {
+public:
+	Reader(const char* p, size_t n) : p(p), end(p + n) {}
+	bool ok = true;
+	uint8_t u8() { uint8_t v = 0; raw(&v, sizeof v); return v; }
+	uint32_t u32() { uint32_t v = 0; raw(&v, sizeof v); return v; }
+	int32_t i32() { int32_t v = 0; raw(&v, sizeof v); return v; }
+	uint64_t u64() { uint64_t v = 0; raw(&v, sizeof v); return v; }
+	std::string_view bytes(size_t n) {
+		if (!check(n)) return std::string_view();
+		std::string_view s(p, n);
+		p += n;
+		return s;
+	}
+	// Rejects element counts that could not possibly fit in the rest of the
+	// data, so a corrupt count never triggers a huge allocation.
+	bool fits(size_t count, size_t minBytesEach) { return check(count * minBytesEach); }
+	bool atEnd() const { return p == end; }
+private:
+	bool check(size_t n) {
+		if (ok && static_cast<size_t>(end - p) >= n) return true;
+		ok = false;
+		return false;
+	}
+	void raw(void* dst, size_t n) {
+		if (!check(n)) return;
+		std::memcpy(dst, p, n);
+		p += n;
+	}
+	const char* p;
+	const char* end;
+};
+
+class Encoder {
+public:
+	Writer nodes;
+	std::vector<std::string_view> strings;
+
+	uint32_t str(std::string_view s) {
+		auto it = index.find(s);
+		if (it != index.end()) return it->second;
+		uint32_t id = static_cast<uint32_t>(strings.size());
+		strings.push_back(s);
+		index.emplace(s, id);
+		return id;
+	}
+
+	void expr(const Expr& e) {
+		nodes.u8(static_cast<uint8_t>(e.kind));
+		switch (e.kind) {
+			case ExprKind::Literal: {
+				const Value& v = static_cast<const LiteralExpr&>(e).value;
+				nodes.u8(static_cast<uint8_t>(v.kind()));
+				switch (v.kind()) {
+					case ValueKind::Int: nodes.u64(static_cast<uint64_t>(v.intValue())); break;
+					case ValueKind::Float: { double f = v.asFloat(); nodes.raw(&f, sizeof f); break; }
+					case ValueKind::Bool: nodes.u8(v.truthy()); break;
+					case ValueKind::Str: nodes.u32(str(v.asStr())); break;
+				}
+				break;
+			}
+			case ExprKind::Identifier: {
+				auto& id = static_cast<const IdentifierExpr&>(e);
+				nodes.u32(str(id.name));
+				nodes.i32(id.slot);
+				break;
+			}
+			case ExprKind::Binary: {
+				auto& bin = static_cast<const BinaryExpr&>(e);
+				nodes.u8(static_cast<uint8_t>(bin.op));
+				expr(*bin.left);
+				expr(*bin.right);
+				break;
+			}
+			case ExprKind::Unary: {
+				auto& un = static_cast<const UnaryExpr&>(e);
+				nodes.u8(static_cast<uint8_t>(un.op));
+				expr(*un.expr);
+				break;
+			}
+		}
+	}
+
+	void stmt(const Stmt& st) {
+		nodes.u8(static_cast<uint8_t>(st.kind));
+		nodes.i32(st.line);
+		switch (st.kind) {
+			case StmtKind::VarDecl: {
+				auto& decl = static_cast<const VarDeclStmt&>(st);
+				nodes.u32(str(decl.typeName));
+				nodes.u32(str(decl.varName));
+				nodes.i32(decl.slot);
+				nodes.u8(static_cast<uint8_t>(decl.declType));
+				nodes.u8(decl.initExpr != nullptr);
+				if (decl.initExpr) expr(*decl.initExpr);
+				break;
+			}
+			case StmtKind::Assign: {
+				auto& as = static_cast<const AssignStmt&>(st);
+				nodes.u32(str(as.varName));
+				nodes.i32(as.slot);
+				nodes.u8(as.appendsInPlace);
+				expr(*as.expr);
+				break;
+			}
+			case StmtKind::Print: {
+				auto& parts = static_cast<const PrintStmt&>(st).parts;
+				nodes.u32(static_cast<uint32_t>(parts.size()));
+				for (const PrintPart& part : parts) {
+					nodes.u32(str(part.text));
+					nodes.u8(part.variable);
+					nodes.i32(part.slot);
+				}
+				break;
+			}
+			case StmtKind::Read: {
+				auto& rd = static_cast<const ReadStmt&>(st);
+				nodes.u32(str(rd.varName));
+				nodes.i32(rd.slot);
+				break;
+			}
+			case StmtKind::Block: {
+				auto& statements = static_cast<const BlockStmt&>(st).statements;
+				nodes.u32(static_cast<uint32_t>(statements.size()));
+				for (const Stmt* child : statements) stmt(*child);
+				break;
+			}
+			case StmtKind::If: {
+				auto& ifs = static_cast<const IfStmt&>(st);
+				expr(*ifs.condition);
+				stmt(*ifs.thenBlock);
+				nodes.u8(ifs.elseBlock != nullptr);
+				if (ifs.elseBlock) stmt(*ifs.elseBlock);
+				break;
+			}
+			case StmtKind::While: {
+				auto& loop = static_cast<const WhileStmt&>(st);
+				expr(*loop.condition);
+				stmt(*loop.body);
+				nodes.u8(loop.step != nullptr);
+				if (loop.step) stmt(*loop.step);
+				break;
+			}
+			case StmtKind::TimeExec:
+				break;
+		}
+	}
+
+private:
+	std::unordered_map<std::string_view, uint32_t> index;
+};
+
+class Decoder {
+public:
+	Decoder(Reader& in, Arena& arena) : in(in), arena(arena) {}
+	std::vector<std::string_view> strings; // views into the mapped file
+	size_t slotCount = 0;
+
+	Expr* expr() {
+		uint8_t kind = in.u8();
+		switch (static_cast<ExprKind>(kind)) {
+			case ExprKind::Literal: {
+				Value v;
+				switch (static_cast<ValueKind>(in.u8())) {
+					case ValueKind::Int: v = Value::fromInt(static_cast<int64_t>(in.u64())); break;
+					case ValueKind::Float: { uint64_t bits = in.u64(); double f; std::memcpy(&f, &bits, sizeof f); v = Value::fromFloat(f); break; }
+					case ValueKind::Bool: v = Value::fromBool(in.u8() != 0); break;
+					case ValueKind::Str: {
+						auto* s = arena.make<StrObj>(std::string(str()), StrObj::kImmortal);
+						v = Value::fromImmortalStr(s);
+						break;
+					}
+					default: return fail();
+				}
+				return in.ok ? arena.make<LiteralExpr>(std::move(v)) : fail();
+			}
+			case ExprKind::Identifier: {
+				auto* id = arena.make<IdentifierExpr>(str());
+				id->slot = slot(false);
+				return in.ok ? id : fail();
+			}
+			case ExprKind::Binary: {
+				uint8_t op = in.u8();
+				if (op > static_cast<uint8_t>(BinaryOp::Or)) return fail();
+				Expr* left = expr();
+				Expr* right = left ? expr() : nullptr;
+				return right ? makeBinary(arena, static_cast<BinaryOp>(op), left, right) : fail();
+			}
+			case ExprKind::Unary: {
+				uint8_t op = in.u8();
+				if (op > static_cast<uint8_t>(UnaryOp::Neg)) return fail();
+				Expr* operand = expr();
+				return operand ? makeUnary(arena, static_cast<UnaryOp>(op), operand) : fail();
+			}
+		}
+		return fail();
+	}
+
+	Stmt* stmt() {
+		uint8_t kind = in.u8();
+		int line = in.i32();
+		Stmt* st = nullptr;
+		switch (static_cast<StmtKind>(kind)) {
+			case StmtKind::VarDecl: {
+				std::string_view typeName = str();
+				std::string_view varName = str();
+				int declSlot = slot(false);
+				uint8_t declType = in.u8();
+				if (declType > static_cast<uint8_t>(VarType::Str)) return fail();
+				Expr* init = nullptr;
+				if (in.u8() && !(init = expr())) return nullptr;
+				auto* decl = arena.make<VarDeclStmt>(typeName, varName, init);
+				decl->slot = declSlot;
+				decl->declType = static_cast<VarType>(declType);
+				st = decl;
+				break;
+			}
+			case StmtKind::Assign: {
+				std::string_view varName = str();
+				int assignSlot = slot(false);
+				bool appendsInPlace = in.u8() != 0;
+				Expr* value = expr();
+				if (!value) return nullptr;
+				auto* as = arena.make<AssignStmt>(varName, value);
+				as->slot = assignSlot;
+				as->appendsInPlace = appendsInPlace;
+				st = as;
+				break;
+			}
+			case StmtKind::Print: {
+				uint32_t count = in.u32();
+				if (!in.fits(count, 9)) return fail();
+				ArenaArray<PrintPart> parts;
+				parts.count = count;
+				if (count) parts.data = static_cast<PrintPart*>(arena.allocate(sizeof(PrintPart) * count, alignof(PrintPart)));
+				for (PrintPart& part : parts) {
+					part.text = str();
+					part.variable = in.u8() != 0;
+					part.slot = slot(!part.variable);
+				}
+				st = arena.make<PrintStmt>(parts);
+				break;
+			}
+			case StmtKind::Read: {
+				auto* rd = arena.make<ReadStmt>(str());
+				rd->slot = slot(false);
+				st = rd;
+				break;
+			}
+			case StmtKind::Block: {
+				uint32_t count = in.u32();
+				if (!in.fits(count, 5)) return fail();
+				auto* block = arena.make<BlockStmt>();
+				block->statements.count = count;
+				if (count) block->statements.data = static_cast<Stmt**>(arena.allocate(sizeof(Stmt*) * count, alignof(Stmt*)));
+				for (Stmt*& child : block->statements)
+					if (!(child = stmt())) return nullptr;
+				st = block;
+				break;
+			}
+			case StmtKind::If: {
+				Expr* cond = expr();
+				BlockStmt* thenBlock = cond ? block() : nullptr;
+				if (!thenBlock) return nullptr;
+				BlockStmt* elseBlock = nullptr;
+				if (in.u8() && !(elseBlock = block())) return nullptr;
+				st = arena.make<IfStmt>(cond, thenBlock, elseBlock);
+				break;
+			}
+			case StmtKind::While: {
+				Expr* cond = expr();
+				BlockStmt* body = cond ? block() : nullptr;
+				if (!body) return nullptr;
+				Stmt* step = nullptr;
+				if (in.u8() && !(step = stmt())) return nullptr;
+				st = arena.make<WhileStmt>(cond, body, step);
+				break;
+			}
+			case StmtKind::TimeExec:
+				st = arena.make<TimeExecStmt>();
+				break;
+			default:
+				return fail();
+		}
+		if (!in.ok) return fail();
+		st->line = line;
+		return st;
+	}
+
+	BlockStmt* block() {
+		Stmt* st = stmt();
+		if (st && st->kind != StmtKind::Block) return fail();
+		return static_cast<BlockStmt*>(st);
+	}
+
+private:
+	std::nullptr_t fail() { in.ok = false; return nullptr; }
+
+	std::string_view str() {
+		uint32_t id = in.u32();
+		if (id < strings.size()) return strings[id];
+		in.ok = false;
+		return std::string_view();
+	}
+
+	// Slots come from the Resolver, so they must index the stored table;
+	// print text parts are the only place -1 is allowed.
+	int slot(bool allowNone) {
+		int32_t s = in.i32();
+		if ((s == -1 && allowNone) || (s >= 0 && static_cast<size_t>(s) < slotCount)) return s;
+		in.ok = false;
+		return -1;
+	}
+
+	Reader& in;
+	Arena& arena;
+};
+
+} // namespace
+
+bool ProgramCache::save(const std::string& path, uint64_t sourceHash, bool optimized, const BlockStmt& program,
+		const SymbolTable& symbols, std::string& errorMsg) {
+	Encoder enc;
+	std::vector<uint32_t> symbolNames;
+	symbolNames.reserve(symbols.size());
+	for (const std::string& name : symbols.names) symbolNames.push_back(enc.str(name));
+	enc.stmt(program);
+
+	Writer payload;
+	payload.u32(static_cast<uint32_t>(enc.strings.size()));
+	for (std::string_view s : enc.strings) {
+		payload.u32(static_cast<uint32_t>(s.size()));
+		payload.raw(s.data(), s.size());
+	}
+	payload.u32(static_cast<uint32_t>(symbolNames.size()));
+	for (size_t i = 0; i < symbolNames.size(); ++i) {
+		payload.u32(symbolNames[i]);
+		payload.u8(symbols.declared[i]);
+	}
+	payload.raw(enc.nodes.out.data(), enc.nodes.out.size());
+
+	Writer header;
+	header.raw(kMagic, sizeof kMagic);
+	header.u32(kVersion);
+	header.u32(kByteOrderMark);
+	header.u64(sourceHash);
+	header.u8(optimized);
+	header.u64(payload.out.size());
+	header.u64(hashBytes(payload.out.data(), payload.out.size(), kVersion));
+
+	std::string tmp = path + ".tmp" + std::to_string(::getpid());
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		if (!out) { errorMsg = "cannot write " + tmp; return false; }
+		out.write(header.out.data(), static_cast<std::streamsize>(header.out.size()));
+		out.write(payload.out.data(), static_cast<std::streamsize>(payload.out.size()));
+		if (!out.flush()) { errorMsg = "cannot write " + tmp; std::remove(tmp.c_str()); return false; }
+	}
+	if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+		errorMsg = std::strerror(errno);
+		std::remove(tmp.c_str());
+		return false;
+	}
+	return true;
+}
+
+BlockStmt* ProgramCache::load(const std::string& path, uint64_t sourceHash, bool optimized, SourceBuffer& file,
+		Arena& arena, SymbolTable& symbols, std::string& errorMsg) {
+	if (!file.open(path, errorMsg)) return nullptr;
+	std::string_view data = file.view();
+	if (data.size() < kHeaderSize) { errorMsg = "truncated header"; return nullptr; }
+
+	Reader header(data.data(), kHeaderSize);
+	if (header.bytes(sizeof kMagic) != std::string_view(kMagic, sizeof kMagic)) { errorMsg = "not a program cache"; return nullptr; }
+	if (header.u32() != kVersion || header.u32() != kByteOrderMark) { errorMsg = "incompatible cache version"; return nullptr; }
+	if (header.u64() != sourceHash) { errorMsg = "stale cache (source changed)"; return nullptr; }
+	if ((header.u8() != 0) != optimized) { errorMsg = "cache built with a different optimizer setting"; return nullptr; }
+	uint64_t payloadSize = header.u64();
+	uint64_t payloadHash = header.u64();
+	std::string_view payload = data.substr(kHeaderSize);
+	if (payload.size() != payloadSize || hashBytes(payload.data(), payload.size(), kVersion) != payloadHash) {
+		errorMsg = "corrupt cache";
+		return nullptr;
+	}
+
+	Reader in(payload.data(), payload.size());
+	Decoder dec(in, arena);
+	uint32_t stringCount = in.u32();
+	if (in.fits(stringCount, 4)) {
+		dec.strings.reserve(stringCount);
+		for (uint32_t i = 0; i < stringCount && in.ok; ++i) dec.strings.push_back(in.bytes(in.u32()));
+	}
+	uint32_t symbolCount = in.u32();
+	SymbolTable loaded;
+	if (in.fits(symbolCount, 5)) {
+		loaded.names.reserve(symbolCount);
+		loaded.declared.reserve(symbolCount);
+		for (uint32_t i = 0; i < symbolCount && in.ok; ++i) {
+			uint32_t name = in.u32();
+			bool declared = in.u8() != 0;
+			if (name >= dec.strings.size()) { in.ok = false; break; }
+			loaded.names.emplace_back(dec.strings[name]); // slots are indexed lazily
+			loaded.declared.push_back(declared);
+		}
+	}
+	dec.slotCount = loaded.size();
+	BlockStmt* program = in.ok ? dec.block() : nullptr;
+	if (!program || !in.atEnd()) {
+		errorMsg = "corrupt cache";
+		return nullptr;
+	}
+	symbols = std::move(loaded);
+	return program;
+}
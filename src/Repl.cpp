@@ -0,0 +1,136 @@
+#include "Repl.h"
+#include "Error.h"
+#include "Output.h"
+#include <iostream>
+#include <cctype>
+#include <sstream>
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+	size_t b = s.find_first_not_of(" \t\r");
+	if (b == std::string_view::npos) return {};
+	size_t e = s.find_last_not_of(" \t\r");
+	return s.substr(b, e - b + 1);
+}
+
+bool startsWithElse(std::string_view text) {
+	if (text.substr(0, 4) != "else") return false;
+	if (text.size() == 4) return true;
+	char c = text[4];
+	return !(std::isalnum(static_cast<unsigned char>(c)) || c == '_');
+}
+
+} // namespace
+
+Repl::Shape Repl::addLine(const std::string& line, int lineNo) {
+	if (pending.lines.empty()) pending.firstLine = lineNo;
+	pending.lines.push_back(line);
+	Lexer lexer;
+	std::vector<Token> tokens = lexer.tokenize(pending.lines.back(), lineNo - pending.firstLine + 1, pending.inComment);
+	pending.inComment = lexer.inComment();
+	tokens.pop_back(); // EndOfInput
+	for (const Token& token : tokens) {
+		pending.tokens.push_back(token);
+		TokenType type = token.type;
+		if (pending.depth == 0) {
+			// A statement after an if's '}' other than its else ends the if.
+			if (pending.lastType == TokenType::RBrace && type != TokenType::KeywordElse) pending.lastIsIf = false;
+			if (type == TokenType::KeywordIf) pending.lastIsIf = true;
+			else if (type == TokenType::KeywordElse || type == TokenType::Semicolon) pending.lastIsIf = false;
+		}
+		if (type == TokenType::LBrace || type == TokenType::LParen) pending.depth++;
+		else if (type == TokenType::RBrace || type == TokenType::RParen) pending.depth--;
+		pending.lastType = type;
+	}
+	if (pending.lastType == TokenType::EndOfInput) return pending.inComment ? Shape::Incomplete : Shape::Complete;
+	if (pending.inComment || pending.depth > 0) return Shape::Incomplete;
+	if (pending.lastType == TokenType::Semicolon) return Shape::Complete;
+	if (pending.lastType != TokenType::RBrace) return Shape::Incomplete;
+	return pending.lastIsIf ? Shape::CompleteIf : Shape::Complete;
+}
+
+void Repl::submit() {
+	Pending entry = std::move(pending);
+	pending = Pending();
+	int firstLine = entry.firstLine;
+	std::vector<Token>& tokens = entry.tokens;
+	if (tokens.empty()) return; // only blanks and comments
+	// Lexing the entry as one text ends it on the line after its last one.
+	tokens.push_back({TokenType::EndOfInput, std::string_view(), static_cast<int>(entry.lines.size()) + 1});
+	std::string key;
+	for (const Token& t : tokens) {
+		key += static_cast<char>(t.type);
+		key.append(t.lexeme);
+		key += '\0';
+	}
+	// Units are compiled from line 1, so a cached one reports the lines of
+	// whichever entry runs it.
+	Err::setLineOffset(firstLine - 1);
+	Err::setCurrentLine(0);
+	auto it = index.find(key);
+	if (it != index.end()) {
+		hits++;
+		lru.splice(lru.begin(), lru, it->second);
+	} else {
+		misses++;
+		std::unique_ptr<Interpreter::Unit> unit = interp.compileUnit(tokens);
+		if (!unit) {
+			Err::setLineOffset(0);
+			return; // diagnostics already printed
+		}
+		if (lru.size() == capacity) {
+			index.erase(lru.back().key);
+			lru.pop_back();
+		}
+		lru.push_front({std::move(key), std::move(unit)});
+		index.emplace(lru.front().key, lru.begin());
+	}
+	interp.runUnit(*lru.front().unit);
+	Err::setLineOffset(0);
+}
+
+bool Repl::command(std::string_view line) {
+	if (line == ":quit") return false;
+	if (line == ":stats") {
+		std::ostringstream out;
+		out << "[repl] cache: " << lru.size() << "/" << capacity << " entradas, " << hits << " acertos, " << misses << " falhas";
+		Out::line(out.str());
+		return true;
+	}
+	Out::flush();
+	std::cerr << "Comando desconhecido: " << line << " (use :stats ou :quit)\n";
+	return true;
+}
+
+void Repl::run(std::istream& in, bool prompt) {
+	std::string line;
+	int lineNo = 0;
+	bool holding = false; // the entry is a complete if that an else may still continue
+	while (true) {
+		if (prompt) {
+			Out::write(pending.lines.empty() ? ">>> " : "... ");
+			Out::flushBeforeRead();
+		}
+		if (!std::getline(in, line)) break;
+		lineNo++;
+		std::string_view text = trim(line);
+		if (!pending.lines.empty() && (text.empty() || (holding && !startsWithElse(text)))) {
+			// A blank line ends an if, or submits an unfinished entry as it is.
+			submit();
+			holding = false;
+			if (text.empty()) continue;
+		}
+		if (pending.lines.empty()) {
+			if (text.empty()) continue;
+			if (text[0] == ':') {
+				if (!command(text)) break;
+				continue;
+			}
+		}
+		Shape shape = addLine(line, lineNo);
+		holding = shape == Shape::CompleteIf;
+		if (shape == Shape::Complete) submit();
+	}
+	if (!pending.lines.empty()) submit();
+}
@@ -0,0 +1,85 @@
+#include "Resolver.h"
+
+static VarType declTypeFromName(std::string_view typeName) {
+	if (typeName == "int") return VarType::Int;
+	if (typeName == "float") return VarType::Float;
+	if (typeName == "str") return VarType::Str;
+	return VarType::Undeclared; // auto: inferred from the initializer at runtime
+}
+
+void Resolver::resolveExpr(Expr& e) {
+	switch (e.kind) {
+		case ExprKind::Literal:
+			break;
+		case ExprKind::Identifier: {
+			auto& id = static_cast<IdentifierExpr&>(e);
+			id.slot = symbols.intern(id.name);
+			break;
+		}
+		case ExprKind::Binary: {
+			auto& bin = static_cast<BinaryExpr&>(e);
+			resolveExpr(*bin.left);
+			resolveExpr(*bin.right);
+			break;
+		}
+		case ExprKind::Unary:
+			resolveExpr(*static_cast<UnaryExpr&>(e).expr);
+			break;
+	}
+}
+
+bool Resolver::resolve(Stmt& st, std::string& errorMsg) {
+	switch (st.kind) {
+		case StmtKind::VarDecl: {
+			auto& decl = static_cast<VarDeclStmt&>(st);
+			if (decl.initExpr) resolveExpr(*decl.initExpr);
+			decl.slot = symbols.intern(decl.varName);
+			decl.declType = declTypeFromName(decl.typeName);
+			symbols.declared[decl.slot] = true;
+			break;
+		}
+		case StmtKind::Assign: {
+			auto& as = static_cast<AssignStmt&>(st);
+			resolveExpr(*as.expr);
+			as.slot = symbols.intern(as.varName);
+			break;
+		}
+		case StmtKind::Read: {
+			auto& rd = static_cast<ReadStmt&>(st);
+			rd.slot = symbols.intern(rd.varName);
+			break;
+		}
+		case StmtKind::Print:
+			for (auto& part : static_cast<PrintStmt&>(st).parts) {
+				if (!part.variable) continue;
+				part.slot = symbols.lookup(part.text);
+				if (part.slot < 0 || !symbols.declared[part.slot]) {
+					errorMsg = "unknown variable in print: {" + std::string(part.text) + "}";
+					errorLine_ = st.line;
+					return false;
+				}
+			}
+			break;
+		case StmtKind::Block:
+			for (auto& child : static_cast<BlockStmt&>(st).statements)
+				if (!resolve(*child, errorMsg)) return false;
+			break;
+		case StmtKind::If: {
+			auto& ifs = static_cast<IfStmt&>(st);
+			resolveExpr(*ifs.condition);
+			if (!resolve(*ifs.thenBlock, errorMsg)) return false;
+			if (ifs.elseBlock && !resolve(*ifs.elseBlock, errorMsg)) return false;
+			break;
+		}
+		case StmtKind::While: {
+			auto& loop = static_cast<WhileStmt&>(st);
+			resolveExpr(*loop.condition);
+			if (!resolve(*loop.body, errorMsg)) return false;
+			if (loop.step && !resolve(*loop.step, errorMsg)) return false;
+			break;
+		}
+		case StmtKind::TimeExec:
+			break;
+	}
+	return true;
+}
@@ -0,0 +1,174 @@
+#include "Runtime.h"
+#include "Error.h"
+#include "Input.h"
+#include "Numeric.h"
+#include "Output.h"
+#include "Trace.h"
+
+// Converts a value to the declared type of a variable; prints the mismatch
+// and returns false when the value cannot be stored there.
+static bool coerceToType(VarType type, Value& v) {
+	if (type == VarType::Int) {
+		if (v.kind() == ValueKind::Float) {
+			Err::stream() << "[fatal] type mismatch: cannot assign float to int\n";
+			return false;
+		}
+		if (v.isStr()) {
+			Err::stream() << "[fatal] type mismatch: cannot assign string to int\n";
+			return false;
+		}
+		if (v.kind() != ValueKind::Int) v = Value::fromInt(v.asInt());
+	} else if (type == VarType::Float) {
+		if (v.isStr()) {
+			Err::stream() << "[fatal] type mismatch: cannot assign non-number to float\n";
+			return false;
+		}
+		if (v.kind() != ValueKind::Float) v = Value::fromFloat(v.asFloat());
+	} else if (type == VarType::Str) {
+		if (!v.isStr()) v = Value::fromStr(v.toString());
+	}
+	return true;
+}
+
+static VarType varTypeOf(const Value& v) {
+	switch (v.kind()) {
+		case ValueKind::Float: return VarType::Float;
+		case ValueKind::Str: return VarType::Str;
+		default: return VarType::Int;
+	}
+}
+
+// Variables can outlive the program that computed their value, so literal
+// strings owned by its arena are copied before being stored.
+static void store(Frame& frame, int slot, Value value) {
+	if (value.isImmortalStr()) value = Value::fromStr(value.asStr());
+	frame.values[slot] = std::move(value);
+}
+
+static const std::string& nameOf(const Frame& frame, int slot) {
+	return frame.symbols->names[slot];
+}
+
+Value Runtime::defaultValue(VarType type) {
+	if (type == VarType::Float) return Value::fromFloat(0.0);
+	static StrObj empty("", StrObj::kImmortal); // shared, so never counted
+	if (type == VarType::Str) return Value::fromImmortalStr(&empty);
+	return Value::fromInt(0);
+}
+
+Value Runtime::undefinedValue() {
+	return Value::fromStr("undefined");
+}
+
+bool Runtime::declare(Frame& frame, int slot, VarType declType, Value value) {
+	if (declType == VarType::Undeclared && value.kind() == ValueKind::Bool) value = Value::fromInt(value.asInt());
+	if (!coerceToType(declType, value)) return false;
+	frame.types[slot] = (declType == VarType::Undeclared) ? varTypeOf(value) : declType;
+	store(frame, slot, std::move(value));
+	return true;
+}
+
+bool Runtime::assign(Frame& frame, int slot, Value value) {
+	VarType type = frame.types[slot];
+	if (type == VarType::Undeclared) {
+		Err::stream() << "[error] assignment to undeclared variable: " << nameOf(frame, slot) << '\n';
+		return false;
+	}
+	if (!coerceToType(type, value)) return false;
+	store(frame, slot, std::move(value));
+	return true;
+}
+
+bool Runtime::read(Frame& frame, int slot) {
+	VarType type = frame.types[slot];
+	if (type == VarType::Undeclared) {
+		Err::stream() << "[error] undeclared variable: " << nameOf(frame, slot) << '\n';
+		return false;
+	}
+	std::string_view input;
+	if (In::isBulk()) {
+		input = In::readLine();
+	} else {
+		Out::write(nameOf(frame, slot));
+		Out::write(": ");
+		Out::flushBeforeRead();
+		auto waitStart = Trace::Clock::now();
+		input = In::readLine();
+		if (frame.trace) frame.trace->add(Phase::InputWait, waitStart, Trace::Clock::now());
+	}
+	if (type == VarType::Int) {
+		int64_t v = 0;
+		if (!Numeric::parseInt(input, v)) {
+			Err::stream() << "[error] invalid value for int\n";
+			return false;
+		}
+		frame.values[slot] = Value::fromInt(v);
+	} else if (type == VarType::Float) {
+		double v = 0;
+		if (!Numeric::parseFloat(input, v)) {
+			Err::stream() << "[error] invalid value for float\n";
+			return false;
+		}
+		frame.values[slot] = Value::fromFloat(v);
+	} else {
+		frame.values[slot] = Value::fromStr(std::string(input));
+	}
+	return true;
+}
+
+static bool reportArith(ArithError err, const char* op) {
+	if (err == ArithError::None) return true;
+	if (err == ArithError::DivisionByZero) Err::stream() << "[fatal] division by zero\n";
+	else if (err == ArithError::StrTooLong) Err::stream() << "[fatal] string too long (limit " << (StrObj::kMaxSize >> 20) << " MiB)\n";
+	else Err::stream() << "[fatal] type mismatch: '" << op << "' requires numbers\n";
+	return false;
+}
+
+bool Runtime::add(const Value& l, const Value& r, Value& out) {
+	return reportArith(addValues(l, r, out), "+");
+}
+
+bool Runtime::append(Frame& frame, int slot, const Value* tails, int count) {
+	std::string* text = frame.types[slot] == VarType::Str ? frame.values[slot].uniqueStr() : nullptr;
+	if (!text) {
+		// Shared text, or not a str: what 'x + a + ...' means in general.
+		Value acc = load(frame, slot);
+		for (int i = 0; i < count; ++i)
+			if (!add(acc, tails[i], acc)) return false;
+		return assign(frame, slot, std::move(acc));
+	}
+	// std::string grows its capacity geometrically, so this is amortized
+	// O(length of the tails) instead of a copy of the whole text.
+	size_t before = text->size();
+	for (int i = 0; i < count; ++i) {
+		if (tails[i].isStr() && text->size() + tails[i].asStr().size() > StrObj::kMaxSize) {
+			text->resize(before);
+			return reportArith(ArithError::StrTooLong, "+");
+		}
+		tails[i].appendTo(*text);
+	}
+	if (text->size() > StrObj::kMaxSize) {
+		text->resize(before);
+		return reportArith(ArithError::StrTooLong, "+");
+	}
+	return true;
+}
+
+bool Runtime::arith(BinaryOp op, const Value& l, const Value& r, Value& out) {
+	return reportArith(arithValues(op, l, r, out), opSymbol(op));
+}
+
+bool Runtime::negate(const Value& v, Value& out) {
+	return reportArith(negateValue(v, out), opSymbol(UnaryOp::Neg));
+}
+
+void Runtime::print(const Frame& frame, const ArenaArray<PrintPart>& parts) {
+	static thread_local std::string out; // reused so printing does not allocate
+	out.clear();
+	for (const PrintPart& part : parts) {
+		if (!part.variable) out.append(part.text);
+		else if (frame.types[part.slot] != VarType::Undeclared) frame.values[part.slot].appendTo(out);
+		else out += "undefined"; // declaration not executed (e.g. in a skipped branch)
+	}
+	Out::line(out);
+}
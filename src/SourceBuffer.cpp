@@ -0,0 +1,52 @@
+#include "SourceBuffer.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool SourceBuffer::readAll(int fd, std::string& errorMsg) {
+	char chunk[64 * 1024];
+	while (true) {
+		ssize_t n = ::read(fd, chunk, sizeof(chunk));
+		if (n == 0) return true;
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			errorMsg = std::strerror(errno);
+			return false;
+		}
+		owned.append(chunk, static_cast<size_t>(n));
+	}
+}
+
+bool SourceBuffer::open(const std::string& path, std::string& errorMsg) {
+	close();
+	if (path == "-") return readAll(STDIN_FILENO, errorMsg);
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) { errorMsg = std::strerror(errno); return false; }
+	struct stat st;
+	bool ok = true;
+	if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED) {
+			mapped = static_cast<const char*>(p);
+			mappedSize = static_cast<size_t>(st.st_size);
+			::madvise(p, mappedSize, MADV_SEQUENTIAL);
+		} else {
+			ok = readAll(fd, errorMsg);
+		}
+	} else {
+		ok = readAll(fd, errorMsg); // empty files, pipes and other special files
+	}
+	::close(fd);
+	return ok;
+}
+
+void SourceBuffer::close() {
+	if (mapped) ::munmap(const_cast<char*>(mapped), mappedSize);
+	mapped = nullptr;
+	mappedSize = 0;
+	owned.clear();
+}
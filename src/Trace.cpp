@@ -0,0 +1,48 @@
+#include "Trace.h"
+#include <fstream>
+#include <iomanip>
+
+const char* phaseName(Phase phase) {
+	switch (phase) {
+		case Phase::Cache: return "cache";
+		case Phase::Lex: return "lex";
+		case Phase::Parse: return "parse";
+		case Phase::Resolve: return "resolve";
+		case Phase::TypeCheck: return "typecheck";
+		case Phase::Optimize: return "optimize";
+		case Phase::Compile: return "compile";
+		case Phase::Execute: return "execute";
+		case Phase::InputWait: return "input wait";
+		case Phase::Count: break;
+	}
+	return "?";
+}
+
+Trace::Clock::duration Trace::busyTotal() const {
+	Clock::duration sum{};
+	for (int p = 0; p < static_cast<int>(Phase::Count); ++p)
+		if (static_cast<Phase>(p) != Phase::InputWait) sum += totals[p];
+	return sum - total(Phase::InputWait); // input wait happens inside execute
+}
+
+bool Trace::writeChrome(const std::string& path, std::string& errorMsg) const {
+	std::ofstream out(path);
+	if (!out) { errorMsg = "cannot write " + path; return false; }
+	auto micros = [&](Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"bin_prog\"}}";
+	for (const Span& s : spans) {
+		out << ",\n{\"name\":\"" << phaseName(s.phase) << "\",\"cat\":\""
+		    << (s.phase == Phase::InputWait ? "input" : "phase")
+		    << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << micros(s.start - origin)
+		    << ",\"dur\":" << micros(s.end - s.start) << "}";
+	}
+	out << "\n],\"otherData\":{";
+	for (int p = 0; p < static_cast<int>(Phase::Count); ++p) {
+		if (p > 0) out << ",";
+		out << "\"" << phaseName(static_cast<Phase>(p)) << " ms\":" << micros(totals[p]) / 1000.0;
+	}
+	out << "}}\n";
+	return static_cast<bool>(out);
+}
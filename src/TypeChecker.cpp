@@ -0,0 +1,299 @@
+#include "TypeChecker.h"
+#include "TypedExpr.h"
+#include <functional>
+#include <unordered_map>
+
+static bool isNumber(StaticType t) { return t == StaticType::Int || t == StaticType::Float; }
+
+static StaticType typeOfValue(const Value& v) {
+	switch (v.kind()) {
+		case ValueKind::Int: return StaticType::Int;
+		case ValueKind::Float: return StaticType::Float;
+		case ValueKind::Bool: return StaticType::Bool;
+		case ValueKind::Str: return StaticType::Str;
+	}
+	return StaticType::Unknown;
+}
+
+static StaticType typeOfVar(VarType t) {
+	switch (t) {
+		case VarType::Int: return StaticType::Int;
+		case VarType::Float: return StaticType::Float;
+		case VarType::Str: return StaticType::Str;
+		default: return StaticType::Unknown;
+	}
+}
+
+// Arithmetic result when both operands are numbers (bool counts as int).
+static StaticType arithResult(StaticType l, StaticType r) {
+	bool lNum = isNumber(l) || l == StaticType::Bool;
+	bool rNum = isNumber(r) || r == StaticType::Bool;
+	if (!lNum || !rNum) return StaticType::Unknown;
+	return l == StaticType::Float || r == StaticType::Float ? StaticType::Float : StaticType::Int;
+}
+
+template <template <typename> class Node>
+static Expr* makeCompare(Arena& arena, BinaryExpr& bin) {
+	switch (bin.op) {
+		case BinaryOp::Eq: return arena.make<Node<std::equal_to<>>>(bin.op, bin.left, bin.right);
+		case BinaryOp::Ne: return arena.make<Node<std::not_equal_to<>>>(bin.op, bin.left, bin.right);
+		case BinaryOp::Lt: return arena.make<Node<std::less<>>>(bin.op, bin.left, bin.right);
+		case BinaryOp::Le: return arena.make<Node<std::less_equal<>>>(bin.op, bin.left, bin.right);
+		case BinaryOp::Gt: return arena.make<Node<std::greater<>>>(bin.op, bin.left, bin.right);
+		case BinaryOp::Ge: return arena.make<Node<std::greater_equal<>>>(bin.op, bin.left, bin.right);
+		default: return nullptr;
+	}
+}
+
+static Expr* makeArith(Arena& arena, BinaryExpr& bin, bool ints) {
+	switch (bin.op) {
+		case BinaryOp::Add:
+			if (ints) return arena.make<IntArithExpr<TypedOps::Add>>(bin.op, bin.left, bin.right);
+			return arena.make<FloatArithExpr<TypedOps::Add>>(bin.op, bin.left, bin.right);
+		case BinaryOp::Sub:
+			if (ints) return arena.make<IntArithExpr<TypedOps::Sub>>(bin.op, bin.left, bin.right);
+			return arena.make<FloatArithExpr<TypedOps::Sub>>(bin.op, bin.left, bin.right);
+		case BinaryOp::Mul:
+			if (ints) return arena.make<IntArithExpr<TypedOps::Mul>>(bin.op, bin.left, bin.right);
+			return arena.make<FloatArithExpr<TypedOps::Mul>>(bin.op, bin.left, bin.right);
+		case BinaryOp::Div:
+			if (ints) return arena.make<IntDivExpr<TypedOps::Div>>(bin.op, bin.left, bin.right);
+			return arena.make<FloatArithExpr<TypedOps::Div>>(bin.op, bin.left, bin.right);
+		case BinaryOp::Mod:
+			if (ints) return arena.make<IntDivExpr<TypedOps::Mod>>(bin.op, bin.left, bin.right);
+			return arena.make<FloatArithExpr<TypedOps::Mod>>(bin.op, bin.left, bin.right);
+		default:
+			return nullptr;
+	}
+}
+
+// Typed replacement for bin, or null when its operand types do not allow one.
+Expr* TypeChecker::lower(BinaryExpr& bin, StaticType l, StaticType r) {
+	if (isLogical(bin.op)) return nullptr;
+	if (bin.op == BinaryOp::Add && (l == StaticType::Str || r == StaticType::Str))
+		return arena.make<StrConcatExpr>(bin.op, bin.left, bin.right);
+	bool numbers = isNumber(l) && isNumber(r);
+	bool ints = l == StaticType::Int && r == StaticType::Int;
+	if (isArithmetic(bin.op)) return numbers ? makeArith(arena, bin, ints) : nullptr;
+	if (ints) return makeCompare<IntCompareExpr>(arena, bin);
+	if (numbers) return makeCompare<FloatCompareExpr>(arena, bin);
+	if (l == StaticType::Str && r == StaticType::Str) return makeCompare<StrCompareExpr>(arena, bin);
+	return nullptr;
+}
+
+StaticType TypeChecker::typeOf(Expr*& e) {
+	StaticType t = inferType(e);
+	if (jitMode != Jit::Mode::Off) exprTypes[e] = t; // e is the lowered node by now
+	return t;
+}
+
+// Types a statement's expression and lets the Jit wrap it.
+StaticType TypeChecker::typeOfRoot(Expr*& e) {
+	exprTypes.clear();
+	StaticType t = typeOf(e);
+	if (lowering && jitMode != Jit::Mode::Off) Jit::wrap(e, exprTypes, arena, jitMode);
+	return t;
+}
+
+StaticType TypeChecker::inferType(Expr*& e) {
+	switch (e->kind) {
+		case ExprKind::Literal:
+			return typeOfValue(static_cast<LiteralExpr&>(*e).value);
+		case ExprKind::Identifier:
+			return slotTypes[static_cast<IdentifierExpr&>(*e).slot];
+		case ExprKind::Unary: {
+			auto& un = static_cast<UnaryExpr&>(*e);
+			StaticType t = typeOf(un.expr);
+			if (un.op == UnaryOp::Not) return StaticType::Bool;
+			if (t == StaticType::Str) fail(errorLine_, "type mismatch: '-' requires numbers");
+			if (t == StaticType::Bool) return StaticType::Int;
+			return t;
+		}
+		case ExprKind::Binary: {
+			auto& bin = static_cast<BinaryExpr&>(*e);
+			StaticType l = typeOf(bin.left);
+			// The right operand of && and || may be skipped, so an error in it is not certain.
+			if (isLogical(bin.op)) ++skippable;
+			StaticType r = typeOf(bin.right);
+			if (isLogical(bin.op)) --skippable;
+			StaticType result = StaticType::Bool; // comparisons, && and ||
+			if (bin.op == BinaryOp::Add) {
+				result = l == StaticType::Str || r == StaticType::Str ? StaticType::Str : arithResult(l, r);
+			} else if (isArithmetic(bin.op)) {
+				if (l == StaticType::Str || r == StaticType::Str)
+					fail(errorLine_, std::string("type mismatch: '") + opSymbol(bin.op) + "' requires numbers");
+				result = arithResult(l, r);
+			}
+			if (lowering) {
+				if (Expr* typed = lower(bin, l, r)) e = typed;
+			}
+			return result;
+		}
+	}
+	return StaticType::Unknown;
+}
+
+bool TypeChecker::fail(int line, std::string msg) {
+	if (lowering) return true; // the tree was checked before it was optimized or cached
+	if (skippable > 0) return true;
+	if (!errorMsg->empty()) return false; // keep the first error
+	*errorMsg = std::move(msg);
+	errorLine_ = line;
+	return false;
+}
+
+// Mirrors Runtime's coercion rules for declarations and assignments.
+bool TypeChecker::checkStore(int line, VarType target, StaticType value) {
+	if (target == VarType::Int && value == StaticType::Float) return fail(line, "type mismatch: cannot assign float to int");
+	if (target == VarType::Int && value == StaticType::Str) return fail(line, "type mismatch: cannot assign string to int");
+	if (target == VarType::Float && value == StaticType::Str) return fail(line, "type mismatch: cannot assign non-number to float");
+	return true;
+}
+
+void TypeChecker::set(int slot, StaticType type) {
+	if (slotTypes[slot] == type) return;
+	undoLog.push_back({slot, slotTypes[slot]});
+	slotTypes[slot] = type;
+}
+
+void TypeChecker::rollback(size_t mark) {
+	while (undoLog.size() > mark) {
+		slotTypes[undoLog.back().first] = undoLog.back().second;
+		undoLog.pop_back();
+	}
+}
+
+// Current type of every slot changed since mark.
+std::vector<std::pair<int, StaticType>> TypeChecker::changesSince(size_t mark) const {
+	std::vector<std::pair<int, StaticType>> out;
+	for (size_t i = mark; i < undoLog.size(); ++i) out.push_back({undoLog[i].first, slotTypes[undoLog[i].first]});
+	return out;
+}
+
+void TypeChecker::collectDeclared(const Stmt& st, std::vector<int>& slots) const {
+	switch (st.kind) {
+		case StmtKind::VarDecl:
+			slots.push_back(static_cast<const VarDeclStmt&>(st).slot);
+			break;
+		case StmtKind::Block:
+			for (const Stmt* child : static_cast<const BlockStmt&>(st).statements) collectDeclared(*child, slots);
+			break;
+		case StmtKind::If: {
+			auto& ifs = static_cast<const IfStmt&>(st);
+			collectDeclared(*ifs.thenBlock, slots);
+			if (ifs.elseBlock) collectDeclared(*ifs.elseBlock, slots);
+			break;
+		}
+		case StmtKind::While: {
+			auto& loop = static_cast<const WhileStmt&>(st);
+			collectDeclared(*loop.body, slots);
+			if (loop.step) collectDeclared(*loop.step, slots);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+bool TypeChecker::walk(Stmt& st) {
+	errorLine_ = st.line;
+	switch (st.kind) {
+		case StmtKind::VarDecl: {
+			auto& decl = static_cast<VarDeclStmt&>(st);
+			StaticType init = decl.initExpr ? typeOfRoot(decl.initExpr) : StaticType::Int;
+			if (!lowering && !errorMsg->empty()) return false;
+			if (decl.declType != VarType::Undeclared) {
+				if (!checkStore(st.line, decl.declType, init)) return false;
+				set(decl.slot, typeOfVar(decl.declType));
+			} else {
+				set(decl.slot, init == StaticType::Bool ? StaticType::Int : init); // auto
+			}
+			break;
+		}
+		case StmtKind::Assign: {
+			auto& as = static_cast<AssignStmt&>(st);
+			StaticType value = typeOfRoot(as.expr);
+			if (!lowering && !errorMsg->empty()) return false;
+			StaticType target = slotTypes[as.slot];
+			if (target == StaticType::Int && !checkStore(st.line, VarType::Int, value)) return false;
+			if (target == StaticType::Float && !checkStore(st.line, VarType::Float, value)) return false;
+			// Numbers keep the plain '+' (and the engines' int fast paths).
+			if (target == StaticType::Str || target == StaticType::Unknown) {
+				Expr* tails[kMaxAppendTails];
+				as.appendsInPlace = appendTails(as.expr, as.slot, tails) > 0;
+			}
+			break;
+		}
+		case StmtKind::Read:
+		case StmtKind::Print:
+		case StmtKind::TimeExec:
+			break;
+		case StmtKind::Block:
+			for (Stmt* child : static_cast<BlockStmt&>(st).statements)
+				if (!walk(*child)) return false;
+			break;
+		case StmtKind::If: {
+			auto& ifs = static_cast<IfStmt&>(st);
+			typeOfRoot(ifs.condition);
+			if (!lowering && !errorMsg->empty()) return false;
+			// Each branch starts from the current types; afterwards a slot keeps
+			// a type only if both branches agree on it.
+			size_t mark = undoLog.size();
+			if (!walk(*ifs.thenBlock)) return false;
+			auto thenTypes = changesSince(mark);
+			rollback(mark);
+			std::unordered_map<int, StaticType> elseTypes;
+			if (ifs.elseBlock) {
+				if (!walk(*ifs.elseBlock)) return false;
+				for (auto& change : changesSince(mark)) elseTypes[change.first] = change.second;
+				rollback(mark);
+			}
+			std::vector<std::pair<int, StaticType>> merged;
+			for (auto& change : thenTypes) {
+				auto it = elseTypes.find(change.first);
+				StaticType other = it != elseTypes.end() ? it->second : slotTypes[change.first];
+				merged.push_back({change.first, change.second == other ? other : StaticType::Unknown});
+				if (it != elseTypes.end()) elseTypes.erase(it);
+			}
+			for (auto& change : elseTypes)
+				merged.push_back({change.first, change.second == slotTypes[change.first] ? change.second : StaticType::Unknown});
+			for (auto& m : merged) set(m.first, m.second);
+			break;
+		}
+		case StmtKind::While: {
+			auto& loop = static_cast<WhileStmt&>(st);
+			// A declaration in the loop may not have run yet (first iteration)
+			// or may have run with another type, so those slots start unknown.
+			std::vector<int> declared;
+			collectDeclared(loop, declared);
+			for (int slot : declared) set(slot, StaticType::Unknown);
+			typeOfRoot(loop.condition);
+			if (!lowering && !errorMsg->empty()) return false;
+			size_t mark = undoLog.size();
+			if (!walk(*loop.body)) return false;
+			if (loop.step && !walk(*loop.step)) return false;
+			rollback(mark); // the body may not run at all
+			break;
+		}
+	}
+	return true;
+}
+
+bool TypeChecker::check(BlockStmt& program, std::string& msg) {
+	lowering = false;
+	msg.clear();
+	errorMsg = &msg;
+	slotTypes.assign(symbols.size(), StaticType::Unknown);
+	undoLog.clear();
+	return walk(program) && msg.empty();
+}
+
+void TypeChecker::specialize(BlockStmt& program, Jit::Mode jit) {
+	std::string unused;
+	lowering = true;
+	jitMode = jit;
+	errorMsg = &unused;
+	slotTypes.assign(symbols.size(), StaticType::Unknown);
+	undoLog.clear();
+	walk(program);
+}
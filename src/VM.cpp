@@ -0,0 +1,165 @@
+#include "VM.h"
+#include "Error.h"
+#include "Profiler.h"
+#include "Runtime.h"
+#include <functional>
+
+// Threaded dispatch (labels as values) on GCC/Clang, plain switch elsewhere.
+#if defined(__GNUC__)
+#define VM_COMPUTED_GOTO 1
+#else
+#define VM_COMPUTED_GOTO 0
+#endif
+
+#if VM_COMPUTED_GOTO
+#define VM_CASE(name) op_##name
+#define VM_DISPATCH() goto *dispatch[static_cast<uint8_t>(ip->op)]
+#else
+#define VM_CASE(name) case OpCode::name
+#define VM_DISPATCH() continue
+#endif
+#define VM_NEXT() do { ++ip; VM_DISPATCH(); } while (0)
+
+// Loops mostly run on ints; these skip the generic Value helpers for them.
+// Division by 0 and by -1 take the generic path (error, wrap-around).
+#define VM_BOTH_INT() (sp[-2].isInt() && sp[-1].isInt())
+#define VM_INT_COMPARE(cmp) \
+	if (VM_BOTH_INT()) { --sp; sp[-1] = Value::fromBool(sp[-1].intValue() cmp sp->intValue()); VM_NEXT(); }
+
+bool VM::run(const Chunk& chunk, Frame& frame) {
+	if (stack.size() < chunk.maxStack + 1) stack.resize(chunk.maxStack + 1);
+	Value* const base = stack.data();
+	Value* sp = base; // next free stack entry
+	const Instr* const code = chunk.code.data();
+	const Instr* ip = code;
+	const Value* const constants = chunk.constants.data();
+	bool ok = true;
+
+#if VM_COMPUTED_GOTO
+	// Order must match the OpCode enum.
+	static void* const dispatch[] = {
+		&&op_Const, &&op_Load, &&op_Add,
+		&&op_Sub, &&op_Mul, &&op_Div, &&op_Mod, &&op_Neg,
+		&&op_Eq, &&op_Ne, &&op_Lt, &&op_Le, &&op_Gt, &&op_Ge,
+		&&op_Not, &&op_ToBool,
+		&&op_Jump, &&op_JumpIfFalse, &&op_AndJump, &&op_OrJump,
+		&&op_Decl, &&op_Store, &&op_Append, &&op_Print, &&op_Read, &&op_TimeExec,
+		&&op_ProfEnter, &&op_ProfLeave, &&op_ProfEval, &&op_Halt,
+	};
+	VM_DISPATCH();
+	{
+#else
+	for (;;) {
+		switch (ip->op) {
+#endif
+	VM_CASE(Const):
+		*sp++ = constants[ip->arg];
+		VM_NEXT();
+	VM_CASE(Load):
+		*sp++ = Runtime::load(frame, ip->arg);
+		VM_NEXT();
+	VM_CASE(Add): {
+		if (VM_BOTH_INT()) { --sp; sp[-1] = Value::fromInt(wrapAdd(sp[-1].intValue(), sp->intValue())); VM_NEXT(); }
+		Value r = std::move(*--sp);
+		if (!Runtime::add(sp[-1], r, sp[-1])) { ok = false; goto done; }
+		VM_NEXT();
+	}
+	VM_CASE(Sub): {
+		if (VM_BOTH_INT()) { --sp; sp[-1] = Value::fromInt(wrapSub(sp[-1].intValue(), sp->intValue())); VM_NEXT(); }
+		Value r = std::move(*--sp);
+		if (!Runtime::arith(BinaryOp::Sub, sp[-1], r, sp[-1])) { ok = false; goto done; }
+		VM_NEXT();
+	}
+	VM_CASE(Mul): {
+		if (VM_BOTH_INT()) { --sp; sp[-1] = Value::fromInt(wrapMul(sp[-1].intValue(), sp->intValue())); VM_NEXT(); }
+		Value r = std::move(*--sp);
+		if (!Runtime::arith(BinaryOp::Mul, sp[-1], r, sp[-1])) { ok = false; goto done; }
+		VM_NEXT();
+	}
+	VM_CASE(Div): {
+		if (VM_BOTH_INT() && sp[-1].intValue() != 0 && sp[-1].intValue() != -1) { --sp; sp[-1] = Value::fromInt(sp[-1].intValue() / sp->intValue()); VM_NEXT(); }
+		Value r = std::move(*--sp);
+		if (!Runtime::arith(BinaryOp::Div, sp[-1], r, sp[-1])) { ok = false; goto done; }
+		VM_NEXT();
+	}
+	VM_CASE(Mod): {
+		if (VM_BOTH_INT() && sp[-1].intValue() != 0 && sp[-1].intValue() != -1) { --sp; sp[-1] = Value::fromInt(sp[-1].intValue() % sp->intValue()); VM_NEXT(); }
+		Value r = std::move(*--sp);
+		if (!Runtime::arith(BinaryOp::Mod, sp[-1], r, sp[-1])) { ok = false; goto done; }
+		VM_NEXT();
+	}
+	VM_CASE(Neg):
+		if (!Runtime::negate(sp[-1], sp[-1])) { ok = false; goto done; }
+		VM_NEXT();
+	VM_CASE(Eq): { VM_INT_COMPARE(==) Value r = std::move(*--sp); sp[-1] = Value::fromBool(compareValuesWith(sp[-1], r, std::equal_to<>())); VM_NEXT(); }
+	VM_CASE(Ne): { VM_INT_COMPARE(!=) Value r = std::move(*--sp); sp[-1] = Value::fromBool(compareValuesWith(sp[-1], r, std::not_equal_to<>())); VM_NEXT(); }
+	VM_CASE(Lt): { VM_INT_COMPARE(<) Value r = std::move(*--sp); sp[-1] = Value::fromBool(compareValuesWith(sp[-1], r, std::less<>())); VM_NEXT(); }
+	VM_CASE(Le): { VM_INT_COMPARE(<=) Value r = std::move(*--sp); sp[-1] = Value::fromBool(compareValuesWith(sp[-1], r, std::less_equal<>())); VM_NEXT(); }
+	VM_CASE(Gt): { VM_INT_COMPARE(>) Value r = std::move(*--sp); sp[-1] = Value::fromBool(compareValuesWith(sp[-1], r, std::greater<>())); VM_NEXT(); }
+	VM_CASE(Ge): { VM_INT_COMPARE(>=) Value r = std::move(*--sp); sp[-1] = Value::fromBool(compareValuesWith(sp[-1], r, std::greater_equal<>())); VM_NEXT(); }
+	VM_CASE(Not):
+		sp[-1] = Value::fromBool(!sp[-1].truthy());
+		VM_NEXT();
+	VM_CASE(ToBool):
+		sp[-1] = Value::fromBool(sp[-1].truthy());
+		VM_NEXT();
+	VM_CASE(Jump):
+		ip = code + ip->arg;
+		VM_DISPATCH();
+	VM_CASE(JumpIfFalse): {
+		bool cond = (--sp)->truthy();
+		*sp = Value();
+		if (!cond) { ip = code + ip->arg; VM_DISPATCH(); }
+		VM_NEXT();
+	}
+	VM_CASE(AndJump):
+		if (!sp[-1].truthy()) { sp[-1] = Value::fromBool(false); ip = code + ip->arg; VM_DISPATCH(); }
+		*--sp = Value();
+		VM_NEXT();
+	VM_CASE(OrJump):
+		if (sp[-1].truthy()) { sp[-1] = Value::fromBool(true); ip = code + ip->arg; VM_DISPATCH(); }
+		*--sp = Value();
+		VM_NEXT();
+	VM_CASE(Decl):
+		--sp;
+		if (!Runtime::declare(frame, ip->arg, static_cast<VarType>(ip->aux), std::move(*sp))) { ok = false; goto done; }
+		VM_NEXT();
+	VM_CASE(Store):
+		--sp;
+		if (frame.types[ip->arg] == VarType::Int && sp->isInt()) { frame.values[ip->arg] = *sp; VM_NEXT(); }
+		if (!Runtime::assign(frame, ip->arg, std::move(*sp))) { ok = false; goto done; }
+		VM_NEXT();
+	VM_CASE(Append):
+		if (!Runtime::append(frame, ip->arg, sp - ip->aux, ip->aux)) { ok = false; goto done; }
+		for (int i = 0; i < ip->aux; ++i) *--sp = Value();
+		VM_NEXT();
+	VM_CASE(Print):
+		Runtime::print(frame, chunk.prints[ip->arg]);
+		VM_NEXT();
+	VM_CASE(Read):
+		if (!Runtime::read(frame, ip->arg)) { ok = false; goto done; }
+		VM_NEXT();
+	VM_CASE(TimeExec):
+		frame.timeExec = true;
+		VM_NEXT();
+	VM_CASE(ProfEnter):
+		frame.profiler->enter(ip->arg);
+		VM_NEXT();
+	VM_CASE(ProfLeave):
+		frame.profiler->leave(ip->arg);
+		VM_NEXT();
+	VM_CASE(ProfEval):
+		frame.profiler->countEval(ip->arg);
+		VM_NEXT();
+	VM_CASE(Halt):
+		goto done;
+#if !VM_COMPUTED_GOTO
+		}
+#endif
+	}
+
+done:
+	if (!ok) Err::setCurrentLine(chunk.lines[ip - code]);
+	for (Value* v = base; v != sp; ++v) *v = Value();
+	return ok;
+}
@@ -0,0 +1,80 @@
+#include "Value.h"
+#include "Numeric.h"
+#include <cmath>
+#include <functional>
+
+std::string Value::toString() const {
+	std::string out;
+	appendTo(out);
+	return out;
+}
+
+void Value::appendTo(std::string& out) const {
+	switch (kind_) {
+		case ValueKind::Int: Numeric::appendInt(out, p_.i); break;
+		case ValueKind::Float: Numeric::appendFloat(out, p_.f); break;
+		case ValueKind::Bool: out += p_.b ? '1' : '0'; break;
+		case ValueKind::Str: out += p_.s->data; break;
+	}
+}
+
+ArithError addValues(const Value& l, const Value& r, Value& out) {
+	if (l.isNumeric() && r.isNumeric()) {
+		if (l.kind() == ValueKind::Float || r.kind() == ValueKind::Float) out = Value::fromFloat(l.asFloat() + r.asFloat());
+		else out = Value::fromInt(wrapAdd(l.asInt(), r.asInt()));
+		return ArithError::None;
+	}
+	if (l.isStr() && r.isStr() && l.asStr().size() + r.asStr().size() > StrObj::kMaxSize) return ArithError::StrTooLong;
+	std::string s;
+	l.appendTo(s);
+	r.appendTo(s);
+	if (s.size() > StrObj::kMaxSize) return ArithError::StrTooLong;
+	out = Value::fromStr(std::move(s));
+	return ArithError::None;
+}
+
+ArithError arithValues(BinaryOp op, const Value& l, const Value& r, Value& out) {
+	if (!l.isNumeric() || !r.isNumeric()) return ArithError::NotNumber;
+	if (l.kind() == ValueKind::Float || r.kind() == ValueKind::Float) {
+		double a = l.asFloat(), b = r.asFloat();
+		switch (op) {
+			case BinaryOp::Sub: out = Value::fromFloat(a - b); break;
+			case BinaryOp::Mul: out = Value::fromFloat(a * b); break;
+			case BinaryOp::Div: out = Value::fromFloat(a / b); break;
+			default: out = Value::fromFloat(std::fmod(a, b)); break;
+		}
+		return ArithError::None;
+	}
+	uint64_t a = static_cast<uint64_t>(l.asInt()), b = static_cast<uint64_t>(r.asInt());
+	switch (op) {
+		case BinaryOp::Sub: out = Value::fromInt(static_cast<int64_t>(a - b)); break;
+		case BinaryOp::Mul: out = Value::fromInt(static_cast<int64_t>(a * b)); break;
+		default: {
+			int64_t x = l.asInt(), y = r.asInt();
+			if (y == 0) return ArithError::DivisionByZero;
+			if (y == -1) out = Value::fromInt(op == BinaryOp::Div ? static_cast<int64_t>(0 - a) : 0); // INT64_MIN / -1 wraps
+			else out = Value::fromInt(op == BinaryOp::Div ? x / y : x % y);
+			break;
+		}
+	}
+	return ArithError::None;
+}
+
+ArithError negateValue(const Value& v, Value& out) {
+	if (!v.isNumeric()) return ArithError::NotNumber;
+	if (v.kind() == ValueKind::Float) out = Value::fromFloat(-v.asFloat());
+	else out = Value::fromInt(static_cast<int64_t>(0 - static_cast<uint64_t>(v.asInt())));
+	return ArithError::None;
+}
+
+bool compareValues(BinaryOp op, const Value& l, const Value& r) {
+	switch (op) {
+		case BinaryOp::Eq: return compareValuesWith(l, r, std::equal_to<>());
+		case BinaryOp::Ne: return compareValuesWith(l, r, std::not_equal_to<>());
+		case BinaryOp::Lt: return compareValuesWith(l, r, std::less<>());
+		case BinaryOp::Le: return compareValuesWith(l, r, std::less_equal<>());
+		case BinaryOp::Gt: return compareValuesWith(l, r, std::greater<>());
+		case BinaryOp::Ge: return compareValuesWith(l, r, std::greater_equal<>());
+		default: return false;
+	}
+}
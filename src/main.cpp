@@ -1,45 +1,266 @@
 #include "Interpreter.h"
+#include "Dump.h"
+#include "Input.h"
+#include "Output.h"
+#include "Repl.h"
+#include "SourceBuffer.h"
+#include <cerrno>
+#include <charconv>
 #include <chrono>
-#include <fstream>
+#include <cstring>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 #include <iomanip>
-#include "Error.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool openSource(const std::string& path, SourceBuffer& source) {
+    std::string errorMsg;
+    if (source.open(path, errorMsg)) return true;
+    std::cerr << "Erro ao abrir arquivo: " << path << " (" << errorMsg << ")\n";
+    return false;
+}
+
+// Runs a program on one engine with stdin redirected from a string and
+// stdout/stderr captured, unbuffered so diagnostics stay in place.
+static std::string runCaptured(Engine engine, std::string_view source, const std::string& input) {
+    std::istringstream in(input);
+    std::ostringstream out;
+    Out::flush();
+    auto oldPolicy = Out::flushPolicy();
+    Out::setFlushPolicy(Out::FlushPolicy::Always);
+    auto* oldIn = std::cin.rdbuf(in.rdbuf());
+    auto* oldOut = std::cout.rdbuf(out.rdbuf());
+    auto* oldErr = std::cerr.rdbuf(out.rdbuf());
+    Interpreter interp;
+    interp.setEngine(engine);
+    interp.execute(source);
+    std::cin.rdbuf(oldIn);
+    std::cout.rdbuf(oldOut);
+    std::cerr.rdbuf(oldErr);
+    Out::setFlushPolicy(oldPolicy);
+    return out.str();
+}
+
+// --diff: runs every file on the tree walker and the VM, feeding both the
+// same stdin, and reports any difference in their output.
+static int diffEngines(const std::vector<std::string>& paths) {
+    std::ostringstream input;
+    input << std::cin.rdbuf();
+    int failures = 0;
+    for (const auto& path : paths) {
+        SourceBuffer source;
+        if (!openSource(path, source)) { failures++; continue; }
+        std::string tree = runCaptured(Engine::Tree, source.view(), input.str());
+        std::string vm = runCaptured(Engine::VM, source.view(), input.str());
+        if (tree == vm) {
+            std::cout << "[diff] " << path << ": ok\n";
+            continue;
+        }
+        failures++;
+        std::istringstream a(tree), b(vm);
+        std::string la, lb;
+        int line = 1;
+        while (true) {
+            bool hasA = static_cast<bool>(std::getline(a, la));
+            bool hasB = static_cast<bool>(std::getline(b, lb));
+            if (!hasA) la = "<eof>";
+            if (!hasB) lb = "<eof>";
+            if (la != lb || (!hasA && !hasB)) break;
+            line++;
+        }
+        std::cout << "[diff] " << path << ": output line " << line << " differs\n"
+                  << "  tree: " << la << "\n"
+                  << "  vm:   " << lb << "\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
 
 int main(int argc, char** argv) {
-    std::string path = (argc > 1) ? argv[1] : std::string("programs/program.txt");
-    std::ifstream file(path);
-    if (!file) {
-        std::cerr << "Erro ao abrir arquivo: " << path << "\n";
-        return 1;
+    Engine engine = Engine::Tree;
+    bool diff = false;
+    bool repl = false;
+    bool optimize = true;
+    bool dumpAst = false;
+    Jit::Mode jit = Jit::Mode::Off;
+    std::string inputPath;
+    std::string batchPath;
+    unsigned jobs = std::thread::hardware_concurrency();
+    bool profile = false;
+    std::string profilePath;
+    std::string tracePath;
+    enum class CacheMode { Off, NextToSource, Directory } cacheMode = CacheMode::Off;
+    std::string cacheDir;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--engine=tree") engine = Engine::Tree;
+        else if (arg == "--engine=vm") engine = Engine::VM;
+        else if (arg == "--diff") diff = true;
+        else if (arg == "--repl") repl = true;
+        else if (arg == "--no-opt") optimize = false;
+        else if (arg == "--dump-ast") dumpAst = true;
+        else if (arg == "--jit") jit = Jit::Mode::On;
+        else if (arg == "--jit=verify") jit = Jit::Mode::Verify;
+        else if (arg == "--unbuffered") Out::setFlushPolicy(Out::FlushPolicy::Always);
+        else if (arg == "--profile") profile = true;
+        else if (arg.rfind("--profile=", 0) == 0) {
+            profile = true;
+            profilePath = arg.substr(10);
+        }
+        else if (arg.rfind("--trace=", 0) == 0) tracePath = arg.substr(8);
+        else if (arg == "--cache") cacheMode = CacheMode::NextToSource;
+        else if (arg.rfind("--cache=", 0) == 0) {
+            cacheMode = CacheMode::Directory;
+            cacheDir = arg.substr(8);
+        }
+        else if (arg == "--input") {
+            if (i + 1 >= argc) {
+                std::cerr << "Opção --input requer um arquivo\n";
+                return 1;
+            }
+            inputPath = argv[++i];
+        }
+        else if (arg == "--batch") {
+            if (i + 1 >= argc) {
+                std::cerr << "Opção --batch requer um arquivo\n";
+                return 1;
+            }
+            batchPath = argv[++i];
+        }
+        else if (arg.rfind("--jobs=", 0) == 0) {
+            std::string value = arg.substr(7);
+            auto res = std::from_chars(value.data(), value.data() + value.size(), jobs);
+            if (res.ec != std::errc() || res.ptr != value.data() + value.size() || jobs == 0) {
+                std::cerr << "Valor inválido para --jobs: " << value << "\n";
+                return 1;
+            }
+        }
+        else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Opção desconhecida: " << arg << "\n";
+            return 1;
+        } else paths.push_back(arg);
     }
 
     std::ios::sync_with_stdio(false);
     std::cin.tie(nullptr);
 
-    Interpreter interp;
-    auto start = std::chrono::high_resolution_clock::now();
+    if (diff) return diffEngines(paths);
+
+    if (jit != Jit::Mode::Off && engine == Engine::VM) {
+        std::cerr << "--jit só se aplica a --engine=tree\n";
+        return 1;
+    }
+    if (jit != Jit::Mode::Off && !Jit::available()) {
+        std::cerr << "[aviso] --jit requer x86-64 Linux; executando sem JIT\n";
+        jit = Jit::Mode::Off;
+    }
+
+    if (repl && (!paths.empty() || !batchPath.empty() || profile || dumpAst || cacheMode != CacheMode::Off)) {
+        std::cerr << "--repl lê o programa da entrada padrão e não pode ser combinado com um arquivo, --batch, --profile, --dump-ast ou --cache\n";
+        return 1;
+    }
+    std::string path = repl ? std::string("-") : !paths.empty() ? paths[0] : std::string("programs/program.txt");
+    SourceBuffer source;
+    if (!repl && !openSource(path, source)) return 1;
+    SourceBuffer batchInput;
+    if (!batchPath.empty()) {
+        std::string errorMsg;
+        if (!inputPath.empty() || profile || dumpAst) {
+            std::cerr << "--batch não pode ser combinado com --input, --profile ou --dump-ast\n";
+            return 1;
+        }
+        if (path == "-" && batchPath == "-") {
+            std::cerr << "Programa e entrada não podem vir ambos da entrada padrão\n";
+            return 1;
+        }
+        if (!batchInput.open(batchPath, errorMsg)) {
+            std::cerr << "Erro ao abrir arquivo de entrada: " << batchPath << " (" << errorMsg << ")\n";
+            return 1;
+        }
+    }
+    if (!inputPath.empty()) {
+        std::string errorMsg;
+        if (path == "-" && inputPath == "-") {
+            std::cerr << "Programa e entrada não podem vir ambos da entrada padrão\n";
+            return 1;
+        }
+        if (!In::openBulk(inputPath, errorMsg)) {
+            std::cerr << "Erro ao abrir arquivo de entrada: " << inputPath << " (" << errorMsg << ")\n";
+            return 1;
+        }
+    }
 
-    std::string line;
-    int lineNumber = 0;
-    while (std::getline(file, line)) {
-        lineNumber++;
-        Err::setCurrentLine(lineNumber);
-        if (interp.isReadStatement(line)) {
-            auto pause = std::chrono::high_resolution_clock::now();
-            if (!interp.execute(line)) break;
-            auto resume = std::chrono::high_resolution_clock::now();
-            start += (resume - pause);
-        } else {
-            if (!interp.execute(line)) break;
+    Interpreter interp;
+    if (cacheMode == CacheMode::NextToSource) {
+        if (path == "-") {
+            std::cerr << "Programa da entrada padrão só pode usar --cache=<diretório>\n";
+            return 1;
+        }
+        interp.setCache(path + ".cache", false);
+    } else if (cacheMode == CacheMode::Directory) {
+        if (::mkdir(cacheDir.c_str(), 0755) != 0 && errno != EEXIST) {
+            std::cerr << "Erro ao criar diretório de cache: " << cacheDir << " (" << std::strerror(errno) << ")\n";
+            return 1;
         }
+        interp.setCache(cacheDir, true);
     }
+    Profiler profiler;
+    interp.setEngine(engine);
+    interp.setOptimize(optimize);
+    interp.setJit(jit);
+    if (profile) interp.setProfiler(&profiler);
+    Trace& trace = interp.phaseTrace();
+    if (!tracePath.empty()) trace.enableSpans();
+    if (dumpAst) {
+        if (!interp.compile(source.view())) return 1;
+        dumpProgram(*interp.compiledProgram(), std::cout);
+        return 0;
+    }
+    if (repl) Repl(interp).run(std::cin, ::isatty(STDIN_FILENO));
+    else if (batchPath.empty()) interp.execute(source.view());
+    else if (interp.compile(source.view())) interp.runBatch(batchInput.view(), jobs);
 
-    auto end = std::chrono::high_resolution_clock::now();
     if (interp.isTimeExecEnabled()) {
-        double ms = std::chrono::duration<double, std::milli>(end - start).count();
-        std::cout << std::fixed << std::setprecision(3) << "[timeexec] " << ms << " ms\n";
+        auto ms = [](Trace::Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        std::ostringstream report;
+        report << std::fixed << std::setprecision(3) << "[timeexec] " << ms(trace.busyTotal()) << " ms (";
+        const char* separator = "";
+        for (int p = 0; p < static_cast<int>(Phase::Count); ++p) {
+            Phase phase = static_cast<Phase>(p);
+            if (phase == Phase::Compile && engine != Engine::VM) continue;
+            if (phase == Phase::Cache && cacheMode == CacheMode::Off) continue;
+            report << separator;
+            separator = ", ";
+            report << phaseName(phase) << ' ' << ms(trace.total(phase));
+        }
+        report << ")";
+        Out::line(report.str());
     }
 
+    Out::flush();
+    if (jit == Jit::Mode::Verify) {
+        Jit::Stats stats = Jit::stats();
+        std::cerr << "[jit] verify: " << stats.compiled << " expressões compiladas, " << stats.checked
+                  << " resultados conferidos, " << stats.mismatches << " divergências\n";
+    }
+    if (profile) {
+        std::string errorMsg;
+        if (profilePath.empty()) profiler.report(std::cerr);
+        else if (!profiler.writeCollapsed(profilePath, errorMsg)) {
+            std::cerr << "Erro ao gravar perfil: " << errorMsg << "\n";
+            return 1;
+        }
+    }
+    if (!tracePath.empty()) {
+        std::string errorMsg;
+        if (!trace.writeChrome(tracePath, errorMsg)) {
+            std::cerr << "Erro ao gravar trace: " << errorMsg << "\n";
+            return 1;
+        }
+    }
     return 0;
 }